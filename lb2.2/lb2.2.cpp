@@ -1,6 +1,16 @@
 #include <iostream>
+#include <fstream>
 #include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <typeindex>
 #include <limits>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
 
 class Car {
 public:
@@ -14,19 +24,224 @@ public:
 	std::string interior;
 	std::string price;
 
-	void showSpecifications() const {
-		std::cout << "Engine Type: " << engineType << std::endl;
-		std::cout << "Engine Volume: " << engineVolume << " L" << std::endl;
-		std::cout << "ABS: " << (hasABS ? "Yes" : "No") << std::endl;
-		std::cout << "ESP: " << (hasESP ? "Yes" : "No") << std::endl;
-		std::cout << "Airbags: " << airbags << std::endl;
-		std::cout << "Onboard Computer: " << (hasOnboardComputer ? "Yes" : "No") << std::endl;
-		std::cout << "Climate Control: " << climateControl << std::endl;
-		std::cout << "Interior: " << interior << std::endl;
-		std::cout << "Price: $" << price << std::endl;
+	void showSpecifications() const;
+};
+
+class SpecWriter {
+public:
+	virtual ~SpecWriter() = default;
+	virtual void appendHeader(std::string&) const {}
+	virtual void append(const Car& car, std::string& out) const = 0;
+
+	void write(const Car& car, std::ostream& os) const {
+		std::string buffer;
+		append(car, buffer);
+		os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+	}
+
+protected:
+	static void appendNumber(std::string& out, double value) {
+		char buffer[32];
+		auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+		out.append(buffer, result.ptr);
+	}
+
+	static void appendNumber(std::string& out, int value) {
+		char buffer[16];
+		auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+		out.append(buffer, result.ptr);
+	}
+};
+
+class TextSpecWriter : public SpecWriter {
+public:
+	void append(const Car& car, std::string& out) const override {
+		out += "Engine Type: ";
+		out += car.engineType;
+		out += "\nEngine Volume: ";
+		appendStreamNumber(out, car.engineVolume);
+		out += " L\nABS: ";
+		out += car.hasABS ? "Yes" : "No";
+		out += "\nESP: ";
+		out += car.hasESP ? "Yes" : "No";
+		out += "\nAirbags: ";
+		appendNumber(out, car.airbags);
+		out += "\nOnboard Computer: ";
+		out += car.hasOnboardComputer ? "Yes" : "No";
+		out += "\nClimate Control: ";
+		out += car.climateControl;
+		out += "\nInterior: ";
+		out += car.interior;
+		out += "\nPrice: $";
+		out += car.price;
+		out += '\n';
+	}
+
+private:
+	// Same digits as the default std::ostream formatting of a double.
+	static void appendStreamNumber(std::string& out, double value) {
+		char buffer[32];
+		auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, 6);
+		out.append(buffer, result.ptr);
+	}
+};
+
+class CsvSpecWriter : public SpecWriter {
+public:
+	void appendHeader(std::string& out) const override {
+		out += "engine_type,engine_volume,abs,esp,airbags,onboard_computer,climate_control,interior,price\n";
+	}
+
+	void append(const Car& car, std::string& out) const override {
+		appendField(out, car.engineType);
+		out += ',';
+		appendNumber(out, car.engineVolume);
+		out += car.hasABS ? ",1," : ",0,";
+		out += car.hasESP ? "1," : "0,";
+		appendNumber(out, car.airbags);
+		out += car.hasOnboardComputer ? ",1," : ",0,";
+		appendField(out, car.climateControl);
+		out += ',';
+		appendField(out, car.interior);
+		out += ',';
+		appendField(out, car.price);
+		out += '\n';
+	}
+
+private:
+	static void appendField(std::string& out, const std::string& value) {
+		if (value.find_first_of(",\"\r\n") == std::string::npos) {
+			out += value;
+			return;
+		}
+		out += '"';
+		for (char c : value) {
+			if (c == '"') {
+				out += '"';
+			}
+			out += c;
+		}
+		out += '"';
+	}
+};
+
+class JsonLinesSpecWriter : public SpecWriter {
+public:
+	void append(const Car& car, std::string& out) const override {
+		out += "{\"engineType\":";
+		appendString(out, car.engineType);
+		out += ",\"engineVolume\":";
+		appendNumber(out, car.engineVolume);
+		out += ",\"abs\":";
+		out += car.hasABS ? "true" : "false";
+		out += ",\"esp\":";
+		out += car.hasESP ? "true" : "false";
+		out += ",\"airbags\":";
+		appendNumber(out, car.airbags);
+		out += ",\"onboardComputer\":";
+		out += car.hasOnboardComputer ? "true" : "false";
+		out += ",\"climateControl\":";
+		appendString(out, car.climateControl);
+		out += ",\"interior\":";
+		appendString(out, car.interior);
+		out += ",\"price\":";
+		appendString(out, car.price);
+		out += "}\n";
+	}
+
+private:
+	static void appendString(std::string& out, const std::string& value) {
+		static const char hex[] = "0123456789abcdef";
+		out += '"';
+		for (unsigned char c : value) {
+			if (c == '"' || c == '\\') {
+				out += '\\';
+				out += static_cast<char>(c);
+			}
+			else if (c < 0x20) {
+				out += "\\u00";
+				out += hex[c >> 4];
+				out += hex[c & 0xF];
+			}
+			else {
+				out += static_cast<char>(c);
+			}
+		}
+		out += '"';
 	}
 };
 
+// Record layout: flags byte (ABS, ESP, onboard computer), int32 airbags,
+// float64 engine volume, then four uint32 length-prefixed strings.
+// Multi-byte values are written in host byte order.
+class BinarySpecWriter : public SpecWriter {
+public:
+	static constexpr char magic[4] = { 'C', 'A', 'R', 'S' };
+	static constexpr std::uint32_t version = 1;
+
+	void appendHeader(std::string& out) const override {
+		out.append(magic, sizeof(magic));
+		appendRaw(out, version);
+	}
+
+	void append(const Car& car, std::string& out) const override {
+		std::uint8_t flags = (car.hasABS ? 1 : 0) | (car.hasESP ? 2 : 0) | (car.hasOnboardComputer ? 4 : 0);
+		appendRaw(out, flags);
+		appendRaw(out, static_cast<std::int32_t>(car.airbags));
+		appendRaw(out, car.engineVolume);
+		appendString(out, car.engineType);
+		appendString(out, car.climateControl);
+		appendString(out, car.interior);
+		appendString(out, car.price);
+	}
+
+private:
+	template <typename T>
+	static void appendRaw(std::string& out, T value) {
+		char bytes[sizeof(T)];
+		std::memcpy(bytes, &value, sizeof(T));
+		out.append(bytes, sizeof(T));
+	}
+
+	static void appendString(std::string& out, const std::string& value) {
+		appendRaw(out, static_cast<std::uint32_t>(value.size()));
+		out += value;
+	}
+};
+
+void Car::showSpecifications() const {
+	std::string buffer;
+	TextSpecWriter().append(*this, buffer);
+	std::cout << buffer;
+}
+
+// Streams the specifications into the file in large chunks; nothing is flushed per record.
+void exportSpecifications(const std::vector<const Car*>& cars, const SpecWriter& writer, const std::string& path) {
+	constexpr std::size_t chunkSize = 1 << 20;
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file) {
+		throw std::runtime_error("Cannot open " + path + " for writing");
+	}
+
+	std::string buffer;
+	buffer.reserve(chunkSize + 4096);
+	writer.appendHeader(buffer);
+	for (const Car* car : cars) {
+		writer.append(*car, buffer);
+		if (buffer.size() >= chunkSize) {
+			file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+			buffer.clear();
+		}
+	}
+	file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+	file.close();
+
+	if (!file) {
+		throw std::runtime_error("Failed to write " + path);
+	}
+}
+
 class CarBuilder {
 public:
 	virtual ~CarBuilder() = default;
@@ -122,9 +337,135 @@ public:
 	Car* getCar() override { return car; }
 };
 
+struct CarSpecification {
+	std::string engineType;
+	double engineVolume = 0.0;
+	bool hasABS = false;
+	bool hasESP = false;
+	int airbags = 0;
+	bool hasOnboardComputer = false;
+	std::string climateControl;
+	std::string interior;
+	std::string price = "Udefined";
+
+	bool operator==(const CarSpecification& other) const = default;
+};
+
+void validateSpecification(const CarSpecification& spec) {
+	if (spec.engineType.empty() || spec.climateControl.empty() || spec.interior.empty()) {
+		throw std::invalid_argument("Engine type, climate control and interior must not be empty");
+	}
+	if (!(spec.engineVolume > 0)) {
+		throw std::invalid_argument("Engine volume must be a positive number");
+	}
+	if (spec.airbags < 0) {
+		throw std::invalid_argument("Number of airbags must be a non-negative integer");
+	}
+}
+
+// Built cars keyed by the builder type and the full specification they were built from.
+// Cached cars are immutable and shared; the least recently used entry is evicted once
+// the capacity is reached.
+class CarCache {
+public:
+	struct Statistics {
+		std::size_t hits = 0;
+		std::size_t misses = 0;
+		std::size_t evictions = 0;
+	};
+
+	explicit CarCache(std::size_t capacity = 256) : capacity(capacity == 0 ? 1 : capacity) {}
+
+	std::shared_ptr<const Car> find(std::type_index builderType, const CarSpecification& spec) {
+		auto it = index.find(Key{ builderType, spec, hashOf(builderType, spec) });
+		if (it == index.end()) {
+			++stats.misses;
+			return nullptr;
+		}
+		++stats.hits;
+		entries.splice(entries.begin(), entries, it->second);
+		return it->second->car;
+	}
+
+	void insert(std::type_index builderType, const CarSpecification& spec, std::shared_ptr<const Car> car) {
+		Key key{ builderType, spec, hashOf(builderType, spec) };
+		auto it = index.find(key);
+		if (it != index.end()) {
+			it->second->car = std::move(car);
+			entries.splice(entries.begin(), entries, it->second);
+			return;
+		}
+		if (entries.size() >= capacity) {
+			index.erase(entries.back().key);
+			entries.pop_back();
+			++stats.evictions;
+		}
+		entries.push_front(Entry{ key, std::move(car) });
+		index.emplace(std::move(key), entries.begin());
+	}
+
+	const Statistics& statistics() const { return stats; }
+	std::size_t size() const { return entries.size(); }
+
+private:
+	struct Key {
+		std::type_index builderType;
+		CarSpecification spec;
+		std::size_t hash;
+
+		bool operator==(const Key& other) const {
+			return hash == other.hash && builderType == other.builderType && spec == other.spec;
+		}
+	};
+
+	struct KeyHash {
+		std::size_t operator()(const Key& key) const { return key.hash; }
+	};
+
+	struct Entry {
+		Key key;
+		std::shared_ptr<const Car> car;
+	};
+
+	static void mix(std::uint64_t& hash, const void* data, std::size_t size) {
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (std::size_t i = 0; i < size; ++i) {
+			hash = (hash ^ bytes[i]) * 1099511628211ull;
+		}
+	}
+
+	static void mix(std::uint64_t& hash, const std::string& value) {
+		std::uint64_t length = value.size();
+		mix(hash, &length, sizeof(length));
+		mix(hash, value.data(), value.size());
+	}
+
+	static std::size_t hashOf(std::type_index builderType, const CarSpecification& spec) {
+		std::uint64_t hash = 14695981039346656037ull;
+		std::uint64_t typeHash = builderType.hash_code();
+		std::uint8_t flags = (spec.hasABS ? 1 : 0) | (spec.hasESP ? 2 : 0) | (spec.hasOnboardComputer ? 4 : 0);
+		double volume = spec.engineVolume == 0.0 ? 0.0 : spec.engineVolume;
+		mix(hash, &typeHash, sizeof(typeHash));
+		mix(hash, spec.engineType);
+		mix(hash, &volume, sizeof(volume));
+		mix(hash, &flags, sizeof(flags));
+		mix(hash, &spec.airbags, sizeof(spec.airbags));
+		mix(hash, spec.climateControl);
+		mix(hash, spec.interior);
+		mix(hash, spec.price);
+		return static_cast<std::size_t>(hash);
+	}
+
+	std::size_t capacity;
+	std::list<Entry> entries;
+	std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+	Statistics stats;
+};
+
 class CarDirector {
 private:
 	CarBuilder* builder;
+	CarCache cache;
 public:
 	void setBuilder(CarBuilder* newBuilder) {
 		builder = newBuilder;
@@ -142,19 +483,16 @@ public:
 		builder->setPrice("20000");
 	}
 
-	void buildCustomCar() {
-		std::string engineType, climateControl, interior, price = "Udefined";
-		double engineVolume = 0.0;
-		bool hasABS = false, hasESP = false, hasOnboardComputer = false;
-		int airbags = 0;
+	CarSpecification readCustomSpecification() {
+		CarSpecification spec;
 
 		std::cout << "Enter Engine Type: ";
-		std::cin >> engineType;
+		std::cin >> spec.engineType;
 
 		while (true) {
 			std::cout << "Enter Engine Volume: ";
-			std::cin >> engineVolume;
-			if (std::cin.fail() || engineVolume <= 0) {
+			std::cin >> spec.engineVolume;
+			if (std::cin.fail() || spec.engineVolume <= 0) {
 				std::cout << "Invalid input! Engine volume must be a positive number.\n";
 				clearInputStream();
 			}
@@ -165,8 +503,8 @@ public:
 
 		while (true) {
 			std::cout << "Enter number of Airbags: ";
-			std::cin >> airbags;
-			if (std::cin.fail() || airbags < 0) {
+			std::cin >> spec.airbags;
+			if (std::cin.fail() || spec.airbags < 0) {
 				std::cout << "Invalid input! Number of airbags must be a non-negative integer.\n";
 				clearInputStream();
 			}
@@ -176,22 +514,45 @@ public:
 		}
 
 		std::cout << "Enter Climate Control: ";
-		std::cin >> climateControl;
+		std::cin >> spec.climateControl;
 
 		std::cout << "Enter Interior: ";
-		std::cin >> interior;
+		std::cin >> spec.interior;
+
+		return spec;
+	}
+
+	void applySpecification(const CarSpecification& spec) {
+		builder->setEngineType(spec.engineType);
+		builder->setEngineVolume(spec.engineVolume);
+		builder->setABS(spec.hasABS);
+		builder->setESP(spec.hasESP);
+		builder->setAirbags(spec.airbags);
+		builder->setOnboardComputer(spec.hasOnboardComputer);
+		builder->setClimateControl(spec.climateControl);
+		builder->setInterior(spec.interior);
+		builder->setPrice(spec.price);
+	}
+
+	// A cache hit returns the earlier car without running the builder, so getCar() keeps
+	// whatever the builder produced last; use the returned car instead.
+	std::shared_ptr<const Car> buildCustomCar(const CarSpecification& spec) {
+		validateSpecification(spec);
 
-		builder->setEngineType(engineType);
-		builder->setEngineVolume(engineVolume);
-		builder->setABS(hasABS);
-		builder->setESP(hasESP);
-		builder->setAirbags(airbags);
-		builder->setOnboardComputer(hasOnboardComputer);
-		builder->setClimateControl(climateControl);
-		builder->setInterior(interior);
-		builder->setPrice(price);
+		std::type_index builderType(typeid(*builder));
+		if (auto car = cache.find(builderType, spec)) {
+			return car;
+		}
+
+		applySpecification(spec);
+		auto car = std::make_shared<const Car>(*builder->getCar());
+		cache.insert(builderType, spec, car);
+		return car;
 	}
 
+	const CarCache::Statistics& cacheStatistics() const {
+		return cache.statistics();
+	}
 
 	Car* getCar() {
 		return builder->getCar();
@@ -207,57 +568,63 @@ void clearInputStream() {
 	std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 }
 
-void buildAndCopySpecifications(CarDirector& director, CarBuilder* baseBuilder, CarBuilder* comfortBuilder, CarBuilder* luxuryBuilder, CarBuilder* electricBuilder) {
+std::vector<std::shared_ptr<const Car>> buildAndCopySpecifications(CarDirector& director, CarBuilder* baseBuilder, CarBuilder* comfortBuilder, CarBuilder* luxuryBuilder, CarBuilder* electricBuilder) {
 	std::cout << "Enter the specifications for all cars:\n";
 
 	director.setBuilder(baseBuilder);
-	director.buildCustomCar();
-	Car* baseCar = director.getCar();
+	CarSpecification spec = director.readCustomSpecification();
+	std::shared_ptr<const Car> baseCar = director.buildCustomCar(spec);
 
 	director.setBuilder(comfortBuilder);
-	comfortBuilder->setEngineType(baseCar->engineType);
-	comfortBuilder->setEngineVolume(baseCar->engineVolume);
-	comfortBuilder->setABS(baseCar->hasABS);
-	comfortBuilder->setESP(baseCar->hasESP);
-	comfortBuilder->setAirbags(baseCar->airbags);
-	comfortBuilder->setOnboardComputer(baseCar->hasOnboardComputer);
-	comfortBuilder->setClimateControl(baseCar->climateControl);
-	comfortBuilder->setInterior(baseCar->interior);
-	comfortBuilder->setPrice(baseCar->price);
+	std::shared_ptr<const Car> comfortCar = director.buildCustomCar(spec);
 
 	director.setBuilder(luxuryBuilder);
-	luxuryBuilder->setEngineType(baseCar->engineType);
-	luxuryBuilder->setEngineVolume(baseCar->engineVolume);
-	luxuryBuilder->setABS(baseCar->hasABS);
-	luxuryBuilder->setESP(baseCar->hasESP);
-	luxuryBuilder->setAirbags(baseCar->airbags);
-	luxuryBuilder->setOnboardComputer(baseCar->hasOnboardComputer);
-	luxuryBuilder->setClimateControl(baseCar->climateControl);
-	luxuryBuilder->setInterior(baseCar->interior);
-	luxuryBuilder->setPrice(baseCar->price);
+	std::shared_ptr<const Car> luxuryCar = director.buildCustomCar(spec);
 
 	director.setBuilder(electricBuilder);
-	electricBuilder->setEngineType(baseCar->engineType);
-	electricBuilder->setEngineVolume(baseCar->engineVolume);
-	electricBuilder->setABS(baseCar->hasABS);
-	electricBuilder->setESP(baseCar->hasESP);
-	electricBuilder->setAirbags(baseCar->airbags);
-	electricBuilder->setOnboardComputer(baseCar->hasOnboardComputer);
-	electricBuilder->setClimateControl(baseCar->climateControl);
-	electricBuilder->setInterior(baseCar->interior);
-	electricBuilder->setPrice(baseCar->price);
+	std::shared_ptr<const Car> electricCar = director.buildCustomCar(spec);
 
 	std::cout << "\nBase Car Specifications:\n";
 	baseCar->showSpecifications();
 
 	std::cout << "\nComfort Car Specifications:\n";
-	comfortBuilder->getCar()->showSpecifications();
+	comfortCar->showSpecifications();
 
 	std::cout << "\nLuxury Car Specifications:\n";
-	luxuryBuilder->getCar()->showSpecifications();
+	luxuryCar->showSpecifications();
 
 	std::cout << "\nElectric Car Specifications:\n";
-	electricBuilder->getCar()->showSpecifications();
+	electricCar->showSpecifications();
+
+	return { baseCar, comfortCar, luxuryCar, electricCar };
+}
+
+void exportSpecificationsMenu(const std::vector<const Car*>& cars) {
+	int format;
+	std::cout << "\nExport specifications: (0) Skip, (1) Text, (2) CSV, (3) JSON lines, (4) Binary\n";
+	std::cin >> format;
+	if (std::cin.fail() || format < 1 || format > 4) {
+		clearInputStream();
+		return;
+	}
+
+	std::string path;
+	std::cout << "Enter file name: ";
+	std::cin >> path;
+
+	TextSpecWriter textWriter;
+	CsvSpecWriter csvWriter;
+	JsonLinesSpecWriter jsonWriter;
+	BinarySpecWriter binaryWriter;
+	const SpecWriter* writers[] = { &textWriter, &csvWriter, &jsonWriter, &binaryWriter };
+
+	try {
+		exportSpecifications(cars, *writers[format - 1], path);
+		std::cout << "Exported " << cars.size() << " specification(s) to " << path << "\n";
+	}
+	catch (const std::exception& ex) {
+		std::cerr << "Error: " << ex.what() << "\n";
+	}
 }
 
 
@@ -268,101 +635,128 @@ int main() {
 	CarBuilder* luxuryBuilder = new LuxuryCarBuilder();
 	CarBuilder* electricBuilder = new ElectricCarBuilder();
 
-	int choice;
-	while (true) {
-		std::cout << "Select configuration: (1) Base, (2) Comfort, (3) Luxury, (4) Electric, (5) All Cars\n";
-		std::cin >> choice;
+	int another = 1;
+	while (another == 1) {
+		int choice;
+		while (true) {
+			std::cout << "Select configuration: (1) Base, (2) Comfort, (3) Luxury, (4) Electric, (5) All Cars\n";
+			std::cin >> choice;
 
-		if (std::cin.fail()) {
-			std::cout << "Invalid input. Please enter a number.\n";
-			clearInputStream();
-			continue;
-		}
+			if (std::cin.fail()) {
+				std::cout << "Invalid input. Please enter a number.\n";
+				clearInputStream();
+				continue;
+			}
 
-		if (choice >= 1 && choice <= 5) {
-			break;
+			if (choice >= 1 && choice <= 5) {
+				break;
+			}
+
+			std::cout << "Invalid choice. Please select between 1 and 5.\n";
 		}
 
-		std::cout << "Invalid choice. Please select between 1 and 5.\n";
-	}
+		std::vector<const Car*> cars;
+		std::vector<std::shared_ptr<const Car>> customCars;
+		int customChoice;
+		std::cout << "Do you want to use a pre-defined template (1) or create your own (2)?\n";
+		std::cin >> customChoice;
 
-	int customChoice;
-	std::cout << "Do you want to use a pre-defined template (1) or create your own (2)?\n";
-	std::cin >> customChoice;
+		if (choice == 5) {
+			if (customChoice == 1) {
+				director.setBuilder(baseBuilder);
+				director.buildCar();
+				Car* baseCar = director.getCar();
 
-	if (choice == 5) {
-		if (customChoice == 1) {
-			director.setBuilder(baseBuilder);
-			director.buildCar();
-			Car* baseCar = director.getCar();
+				director.setBuilder(comfortBuilder);
+				director.buildCar();
+				Car* comfortCar = director.getCar();
 
-			director.setBuilder(comfortBuilder);
-			director.buildCar();
-			Car* comfortCar = director.getCar();
+				director.setBuilder(luxuryBuilder);
+				director.buildCar();
+				Car* luxuryCar = director.getCar();
 
-			director.setBuilder(luxuryBuilder);
-			director.buildCar();
-			Car* luxuryCar = director.getCar();
+				director.setBuilder(electricBuilder);
+				director.buildCar();
+				Car* electricCar = director.getCar();
 
-			director.setBuilder(electricBuilder);
-			director.buildCar();
-			Car* electricCar = director.getCar();
+				std::cout << "\nBase Car Specifications:\n";
+				baseCar->showSpecifications();
 
-			std::cout << "\nBase Car Specifications:\n";
-			baseCar->showSpecifications();
+				std::cout << "\nComfort Car Specifications:\n";
+				comfortCar->showSpecifications();
 
-			std::cout << "\nComfort Car Specifications:\n";
-			comfortCar->showSpecifications();
+				std::cout << "\nLuxury Car Specifications:\n";
+				luxuryCar->showSpecifications();
 
-			std::cout << "\nLuxury Car Specifications:\n";
-			luxuryCar->showSpecifications();
+				std::cout << "\nElectric Car Specifications:\n";
+				electricCar->showSpecifications();
 
-			std::cout << "\nElectric Car Specifications:\n";
-			electricCar->showSpecifications();
-		}
-		else {
-			buildAndCopySpecifications(director, baseBuilder, comfortBuilder, luxuryBuilder, electricBuilder);
-		}
-	}
-	else {
-		if (customChoice == 1) {
-			switch (choice) {
-			case 1:
-				director.setBuilder(baseBuilder);
-				break;
-			case 2:
-				director.setBuilder(comfortBuilder);
-				break;
-			case 3:
-				director.setBuilder(luxuryBuilder);
-				break;
-			case 4:
-				director.setBuilder(electricBuilder);
-				break;
+				cars = { baseCar, comfortCar, luxuryCar, electricCar };
+			}
+			else {
+				customCars = buildAndCopySpecifications(director, baseBuilder, comfortBuilder, luxuryBuilder, electricBuilder);
+				for (const auto& car : customCars) {
+					cars.push_back(car.get());
+				}
 			}
-			director.buildCar();
 		}
 		else {
-			switch (choice) {
-			case 1:
-				director.setBuilder(baseBuilder);
-				break;
-			case 2:
-				director.setBuilder(comfortBuilder);
-				break;
-			case 3:
-				director.setBuilder(luxuryBuilder);
-				break;
-			case 4:
-				director.setBuilder(electricBuilder);
-				break;
+			if (customChoice == 1) {
+				switch (choice) {
+				case 1:
+					director.setBuilder(baseBuilder);
+					break;
+				case 2:
+					director.setBuilder(comfortBuilder);
+					break;
+				case 3:
+					director.setBuilder(luxuryBuilder);
+					break;
+				case 4:
+					director.setBuilder(electricBuilder);
+					break;
+				}
+				director.buildCar();
 			}
-			director.buildCustomCar();
+			else {
+				switch (choice) {
+				case 1:
+					director.setBuilder(baseBuilder);
+					break;
+				case 2:
+					director.setBuilder(comfortBuilder);
+					break;
+				case 3:
+					director.setBuilder(luxuryBuilder);
+					break;
+				case 4:
+					director.setBuilder(electricBuilder);
+					break;
+				}
+				customCars.push_back(director.buildCustomCar(director.readCustomSpecification()));
+			}
+
+			const Car* car = customCars.empty() ? director.getCar() : customCars.back().get();
+			std::cout << "\nCar Specifications:\n";
+			car->showSpecifications();
+			cars.push_back(car);
 		}
 
-		Car* car = director.getCar();
-		std::cout << "\nCar Specifications:\n";
-		car->showSpecifications();
+		exportSpecificationsMenu(cars);
+
+		// Custom cars with a specification seen before come from the director's cache.
+		const CarCache::Statistics& stats = director.cacheStatistics();
+		if (stats.hits + stats.misses != 0) {
+			std::cout << "Car cache: " << stats.hits << " hit(s), " << stats.misses << " miss(es), "
+				<< stats.evictions << " eviction(s)\n";
+		}
+
+		std::cout << "\nConfigure another car? (1) Yes, (0) Exit\n";
+		std::cin >> another;
+		if (std::cin.fail()) {
+			clearInputStream();
+			another = 0;
+		}
 	}
 
 	delete baseBuilder;
@@ -1,19 +1,164 @@
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include <iostream>
+#include <fstream>
 #include <vector>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <memory_resource>
+#include <concepts>
+#include <span>
+#include <thread>
+#include <list>
+#include <exception>
+#include <algorithm>
+#include <stdexcept>
+#include <array>
+#include <optional>
+#include <limits>
+#include <cstdint>
+#include <bit>
+#include <cstring>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+
+// Shares its value between copies; the first mutation through edit() or assign()
+// detaches the writer onto its own copy, allocated from the writer's memory resource.
+// A value is only shared between copies in the same resource. An arena may be
+// released while other arenas still refer to it, and sharing a heap value with
+// arena copies would have every thread cloning a prototype count references on
+// the same control block, so copies into another resource get their own value.
+template <typename T>
+class CopyOnWrite {
+public:
+    explicit CopyOnWrite(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : resource(resource), origin(resource), data(make()) {}
+
+    template <typename... Args>
+        requires std::constructible_from<T, Args..., std::pmr::polymorphic_allocator<T>>
+    explicit CopyOnWrite(std::pmr::memory_resource* resource, Args&&... args)
+        : resource(resource), origin(resource), data(make(std::forward<Args>(args)...)) {}
+
+    CopyOnWrite(const CopyOnWrite& other, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : resource(resource), origin(canShare(other.origin) ? other.origin : resource),
+        data(origin == other.origin ? other.data : make(*other.data)) {}
+
+    CopyOnWrite& operator=(const CopyOnWrite& other) {
+        if (this != &other) {
+            if (canShare(other.origin)) {
+                data = other.data;
+                origin = other.origin;
+            }
+            else {
+                data = make(*other.data);
+                origin = resource;
+            }
+        }
+        return *this;
+    }
+
+    const T& get() const { return *data; }
+    const T& operator*() const { return *data; }
+    const T* operator->() const { return data.get(); }
+
+    T& edit() {
+        if (data.use_count() != 1) {
+            data = make(*data);
+            origin = resource;
+        }
+        return *data;
+    }
+
+    template <typename... Args>
+    void assign(Args&&... args) {
+        data = make(std::forward<Args>(args)...);
+        origin = resource;
+    }
+
+    bool sharesWith(const CopyOnWrite& other) const { return data == other.data; }
+
+private:
+    template <typename... Args>
+    std::shared_ptr<T> make(Args&&... args) const {
+        return std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(resource), std::forward<Args>(args)...);
+    }
+
+    bool canShare(std::pmr::memory_resource* source) const {
+        return source == resource || source->is_equal(*resource);
+    }
+
+    std::pmr::memory_resource* resource;
+    // Resource that allocated data; differs from resource while sharing another copy's value.
+    std::pmr::memory_resource* origin;
+    std::shared_ptr<T> data;
+};
+
+enum class HouseType : std::uint8_t {
+    ApartmentBuilding,
+    Cottage,
+};
+
+constexpr std::size_t houseTypeCount = 2;
 
 class House {
 public:
+    using String = std::pmr::string;
+    using OwnerList = std::pmr::vector<std::pmr::string>;
+
     virtual ~House() = default;
 
     virtual void displayInfo() const = 0;
     virtual void editInfo() = 0;
     virtual std::unique_ptr<House> clone() const = 0;
+    // Constructs the copy in memory obtained from alloc; it must be destroyed with
+    // std::destroy_at and its memory released through the same resource.
+    virtual House* clone(std::pmr::polymorphic_allocator<> alloc) const = 0;
+    // Placement form of the above for batch construction: where must hold objectSize()
+    // bytes aligned to objectAlignment().
+    virtual House* cloneAt(void* where, std::pmr::memory_resource* resource) const = 0;
+    virtual std::size_t objectSize() const = 0;
+    virtual std::size_t objectAlignment() const = 0;
+
+    virtual HouseType type() const = 0;
+    virtual std::span<const String> ownerNames() const = 0;
+
+    const String& getAddress() const { return *address; }
+    int getFloors() const { return floors; }
+    double getArea() const { return area; }
+
+    void setAddress(std::string_view addr) { address.assign(addr); }
+    void setFloors(int fl) { floors = fl; }
+    void setArea(double ar) { area = ar; }
 
 protected:
-    std::string address;
+    House(std::string_view addr, int fl, double ar)
+        : address(std::pmr::get_default_resource(), addr), floors(fl), area(ar) {}
+    House(const House& other, std::pmr::memory_resource* resource)
+        : address(other.address, resource), floors(other.floors), area(other.area) {}
+    House(const House& other) = default;
+
+    void readCommonInfo() {
+        std::string addr;
+        std::cout << "Enter new address: ";
+        std::cin >> addr;
+        address.assign(addr);
+        std::cout << "Enter number of floors: ";
+        std::cin >> floors;
+        std::cout << "Enter area: ";
+        std::cin >> area;
+    }
+
+    CopyOnWrite<String> address;
     int floors;
     double area;
 };
@@ -21,104 +166,899 @@ protected:
 class ApartmentBuilding : public House {
 public:
     ApartmentBuilding(const std::string& addr, int fl, double ar, const std::vector<std::string>& owners)
-        : owners(owners) {
-        address = addr;
-        floors = fl;
-        area = ar;
-    }
+        : House(addr, fl, ar), owners(std::pmr::get_default_resource(), owners.begin(), owners.end()) {}
+
+    ApartmentBuilding(const ApartmentBuilding& other, std::pmr::memory_resource* resource)
+        : House(other, resource), owners(other.owners, resource) {}
+    ApartmentBuilding(const ApartmentBuilding& other) = default;
 
     void displayInfo() const override {
         std::cout << "Apartment building:\n"
-            << "Address: " << address << "\n"
+            << "Address: " << *address << "\n"
             << "Floors: " << floors << "\n"
             << "Area: " << area << " sq.m\n"
             << "Owners:\n";
-        for (const auto& owner : owners) {
+        for (const auto& owner : *owners) {
             std::cout << "- " << owner << "\n";
         }
     }
 
     void editInfo() override {
         std::cout << "Edit apartment building.\n";
-        std::cout << "Enter new address: ";
-        std::cin >> address;
-        std::cout << "Enter number of floors: ";
-        std::cin >> floors;
-        std::cout << "Enter area: ";
-        std::cin >> area;
+        readCommonInfo();
 
         std::cout << "Enter number of owners: ";
         int numOwners;
         std::cin >> numOwners;
-        owners.clear();
+        std::vector<std::string> newOwners;
         for (int i = 0; i < numOwners; ++i) {
             std::string owner;
             std::cout << "Owner " << (i + 1) << ": ";
             std::cin >> owner;
-            owners.push_back(owner);
+            newOwners.push_back(owner);
         }
+        setOwners(newOwners);
     }
 
+    HouseType type() const override { return HouseType::ApartmentBuilding; }
+    std::span<const String> ownerNames() const override { return *owners; }
+
+    void setOwners(const std::vector<std::string>& newOwners) { owners.assign(newOwners.begin(), newOwners.end()); }
+    void addOwner(std::string_view owner) { owners.edit().emplace_back(owner); }
+
     std::unique_ptr<House> clone() const override {
         return std::make_unique<ApartmentBuilding>(*this);
     }
 
+    House* clone(std::pmr::polymorphic_allocator<> alloc) const override {
+        return alloc.new_object<ApartmentBuilding>(*this, alloc.resource());
+    }
+
+    House* cloneAt(void* where, std::pmr::memory_resource* resource) const override {
+        return ::new (where) ApartmentBuilding(*this, resource);
+    }
+
+    std::size_t objectSize() const override { return sizeof(ApartmentBuilding); }
+    std::size_t objectAlignment() const override { return alignof(ApartmentBuilding); }
+
 private:
-    std::vector<std::string> owners;
+    CopyOnWrite<OwnerList> owners;
 };
 
 class Cottage : public House {
 public:
     Cottage(const std::string& addr, int fl, double ar, const std::string& owner)
-        : owner(owner) {
-        address = addr;
-        floors = fl;
-        area = ar;
-    }
+        : House(addr, fl, ar), owner(std::pmr::get_default_resource(), owner) {}
+
+    Cottage(const Cottage& other, std::pmr::memory_resource* resource)
+        : House(other, resource), owner(other.owner, resource) {}
+    Cottage(const Cottage& other) = default;
 
     void displayInfo() const override {
         std::cout << "Cottage:\n"
-            << "Address: " << address << "\n"
+            << "Address: " << *address << "\n"
             << "Floors: " << floors << "\n"
             << "Area: " << area << " sq.m\n"
-            << "Owner: " << owner << "\n";
+            << "Owner: " << *owner << "\n";
     }
 
     void editInfo() override {
         std::cout << "Edit cottage.\n";
-        std::cout << "Enter new address: ";
-        std::cin >> address;
-        std::cout << "Enter number of floors: ";
-        std::cin >> floors;
-        std::cout << "Enter area: ";
-        std::cin >> area;
+        readCommonInfo();
+        std::string newOwner;
         std::cout << "Enter new owner: ";
-        std::cin >> owner;
+        std::cin >> newOwner;
+        setOwner(newOwner);
     }
 
+    HouseType type() const override { return HouseType::Cottage; }
+    std::span<const String> ownerNames() const override { return { &*owner, 1 }; }
+
+    void setOwner(std::string_view newOwner) { owner.assign(newOwner); }
+
     std::unique_ptr<House> clone() const override {
         return std::make_unique<Cottage>(*this);
     }
 
+    House* clone(std::pmr::polymorphic_allocator<> alloc) const override {
+        return alloc.new_object<Cottage>(*this, alloc.resource());
+    }
+
+    House* cloneAt(void* where, std::pmr::memory_resource* resource) const override {
+        return ::new (where) Cottage(*this, resource);
+    }
+
+    std::size_t objectSize() const override { return sizeof(Cottage); }
+    std::size_t objectAlignment() const override { return alignof(Cottage); }
+
+private:
+    CopyOnWrite<String> owner;
+};
+
+// Per-house values for a batch; an empty column keeps the prototype's value.
+struct HouseColumns {
+    std::span<const std::string> addresses;
+    std::span<const int> floors;
+    std::span<const double> areas;
+};
+
+// Owns houses constructed in a monotonic arena. Removing houses one by one is not
+// supported; clear() runs the destructors and hands the whole arena back at once.
+class HouseRegistry {
+public:
+    explicit HouseRegistry(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : arena(upstream), houses(upstream) {}
+
+    HouseRegistry(const HouseRegistry&) = delete;
+    HouseRegistry& operator=(const HouseRegistry&) = delete;
+
+    ~HouseRegistry() {
+        clear();
+    }
+
+    House& add(const House& prototype) {
+        houses.push_back(nullptr);
+        try {
+            houses.back() = prototype.clone(std::pmr::polymorphic_allocator<>(&arena));
+        }
+        catch (...) {
+            houses.pop_back();
+            throw;
+        }
+        return *houses.back();
+    }
+
+    // Constructs count copies of prototype back to back in one arena block. Only the
+    // first copy of a slice copies the prototype's values; the rest share them with
+    // that copy. With more than one thread each worker fills a slice in its own arena,
+    // since monotonic_buffer_resource is not thread-safe. The returned span is valid
+    // until the next call that adds houses.
+    std::span<House* const> addCopies(const House& prototype, std::size_t count,
+        const HouseColumns& overrides = {}, unsigned threads = 1) {
+        checkColumn(overrides.addresses.size(), count);
+        checkColumn(overrides.floors.size(), count);
+        checkColumn(overrides.areas.size(), count);
+
+        const std::size_t first = houses.size();
+        if (count == 0) {
+            return {};
+        }
+
+        const std::size_t stride = prototype.objectSize();
+        char* block = static_cast<char*>(arena.allocate(stride * count, prototype.objectAlignment()));
+        houses.resize(first + count);
+
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        threads = static_cast<unsigned>(std::min<std::size_t>(threads, (count + 4095) / 4096));
+
+        auto fill = [&](std::size_t begin, std::size_t end, std::pmr::memory_resource* resource) {
+            for (std::size_t i = begin; i < end; ++i) {
+                const House& source = i == begin ? prototype : *houses[first + begin];
+                houses[first + i] = source.cloneAt(block + i * stride, resource);
+            }
+            for (std::size_t i = begin; i < end; ++i) {
+                House& house = *houses[first + i];
+                if (!overrides.addresses.empty()) {
+                    house.setAddress(overrides.addresses[i]);
+                }
+                if (!overrides.floors.empty()) {
+                    house.setFloors(overrides.floors[i]);
+                }
+                if (!overrides.areas.empty()) {
+                    house.setArea(overrides.areas[i]);
+                }
+            }
+        };
+
+        if (threads <= 1) {
+            try {
+                fill(0, count, &arena);
+            }
+            catch (...) {
+                truncate(first);
+                throw;
+            }
+            return { houses.data() + first, count };
+        }
+
+        std::vector<std::pmr::memory_resource*> resources;
+        for (unsigned t = 0; t < threads; ++t) {
+            resources.push_back(&workerArenas.emplace_back(arena.upstream_resource()));
+        }
+
+        std::vector<std::exception_ptr> errors(threads);
+        std::vector<std::thread> workers;
+        const std::size_t chunk = (count + threads - 1) / threads;
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                try {
+                    fill(t * chunk, std::min(count, (t + 1) * chunk), resources[t]);
+                }
+                catch (...) {
+                    errors[t] = std::current_exception();
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        for (auto& error : errors) {
+            if (error) {
+                truncate(first);
+                std::rethrow_exception(error);
+            }
+        }
+        return { houses.data() + first, count };
+    }
+
+    void clear() {
+        for (House* house : houses) {
+            std::destroy_at(house);
+        }
+        houses.clear();
+        arena.release();
+        workerArenas.clear();
+    }
+
+    std::size_t size() const { return houses.size(); }
+    bool empty() const { return houses.empty(); }
+    House& operator[](std::size_t index) { return *houses[index]; }
+    const House& operator[](std::size_t index) const { return *houses[index]; }
+
+private:
+    // Destroys the houses a failed batch managed to construct; their arena memory is
+    // only reclaimed by clear().
+    void truncate(std::size_t size) {
+        for (std::size_t i = size; i < houses.size(); ++i) {
+            if (houses[i] != nullptr) {
+                std::destroy_at(houses[i]);
+            }
+        }
+        houses.resize(size);
+    }
+
+    static void checkColumn(std::size_t size, std::size_t count) {
+        if (size != 0 && size != count) {
+            throw std::invalid_argument("Override column size does not match house count");
+        }
+    }
+
+    std::pmr::monotonic_buffer_resource arena;
+    std::list<std::pmr::monotonic_buffer_resource> workerArenas;
+    std::pmr::vector<House*> houses;
+};
+
+struct HouseQuery {
+    std::optional<HouseType> type;
+    int minFloors = std::numeric_limits<int>::min();
+    int maxFloors = std::numeric_limits<int>::max();
+    double minArea = -std::numeric_limits<double>::infinity();
+    double maxArea = std::numeric_limits<double>::infinity();
+    std::optional<std::string> owner;
+};
+
+// Columnar snapshot of a registry with sorted indexes on floors and area, a bitmap
+// per house type and an inverted owner index. Ids are registry positions; the index
+// does not follow later edits, call rebuild() after changing the registry.
+class HouseIndex {
+public:
+    void rebuild(const HouseRegistry& houses) {
+        const std::size_t count = houses.size();
+        if (count > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::length_error("Too many houses to index");
+        }
+
+        addressData.clear();
+        addressOffsets.assign(1, 0);
+        floors.resize(count);
+        areas.resize(count);
+        types.resize(count);
+        for (auto& bitmap : typeBitmaps) {
+            bitmap.assign((count + 63) / 64, 0);
+        }
+        ownerIndex.clear();
+
+        for (std::uint32_t id = 0; id < count; ++id) {
+            const House& house = houses[id];
+            addressData += house.getAddress();
+            addressOffsets.push_back(addressData.size());
+            floors[id] = house.getFloors();
+            areas[id] = house.getArea();
+            types[id] = house.type();
+            typeBitmaps[static_cast<std::size_t>(house.type())][id / 64] |= std::uint64_t{ 1 } << (id % 64);
+            for (const auto& owner : house.ownerNames()) {
+                auto& postings = ownerIndex[std::string(owner)];
+                if (postings.empty() || postings.back() != id) {
+                    postings.push_back(id);
+                }
+            }
+        }
+
+        buildSortedIndex(floors, floorsOrder, sortedFloors);
+        buildSortedIndex(areas, areaOrder, sortedAreas);
+    }
+
+    std::size_t size() const { return floors.size(); }
+    std::string_view address(std::uint32_t id) const {
+        return std::string_view(addressData).substr(addressOffsets[id], addressOffsets[id + 1] - addressOffsets[id]);
+    }
+    int floorsOf(std::uint32_t id) const { return floors[id]; }
+    double areaOf(std::uint32_t id) const { return areas[id]; }
+    HouseType typeOf(std::uint32_t id) const { return types[id]; }
+
+    // Starts from the narrowest available index (owner postings, area or floors range,
+    // type bitmap) and checks the remaining predicates against the columns.
+    std::vector<std::uint32_t> find(const HouseQuery& query) const {
+        std::vector<std::uint32_t> result;
+        if (query.minFloors > query.maxFloors || !(query.minArea <= query.maxArea)) {
+            return result;
+        }
+
+        if (query.owner) {
+            auto it = ownerIndex.find(*query.owner);
+            if (it == ownerIndex.end()) {
+                return result;
+            }
+            for (std::uint32_t id : it->second) {
+                if (matches(id, query)) {
+                    result.push_back(id);
+                }
+            }
+            return result;
+        }
+
+        auto [floorsFirst, floorsLast] = range(sortedFloors, query.minFloors, query.maxFloors);
+        auto [areaFirst, areaLast] = range(sortedAreas, query.minArea, query.maxArea);
+        const std::size_t floorsHits = floorsLast - floorsFirst;
+        const std::size_t areaHits = areaLast - areaFirst;
+
+        if (std::min(floorsHits, areaHits) < size() / 4 || !query.type) {
+            const bool useArea = areaHits <= floorsHits;
+            const auto& order = useArea ? areaOrder : floorsOrder;
+            const std::size_t first = useArea ? areaFirst : floorsFirst;
+            const std::size_t last = useArea ? areaLast : floorsLast;
+            for (std::size_t i = first; i < last; ++i) {
+                if (matches(order[i], query)) {
+                    result.push_back(order[i]);
+                }
+            }
+            std::sort(result.begin(), result.end());
+            return result;
+        }
+
+        const auto& bitmap = typeBitmaps[static_cast<std::size_t>(*query.type)];
+        for (std::size_t word = 0; word < bitmap.size(); ++word) {
+            for (std::uint64_t bits = bitmap[word]; bits != 0; bits &= bits - 1) {
+                auto id = static_cast<std::uint32_t>(word * 64 + std::countr_zero(bits));
+                if (matches(id, query)) {
+                    result.push_back(id);
+                }
+            }
+        }
+        return result;
+    }
+
+    std::size_t count(HouseType type) const {
+        std::size_t total = 0;
+        for (std::uint64_t word : typeBitmaps[static_cast<std::size_t>(type)]) {
+            total += std::popcount(word);
+        }
+        return total;
+    }
+
+    std::array<double, houseTypeCount> totalAreaByType() const {
+        std::array<double, houseTypeCount> totals{};
+        for (std::size_t id = 0; id < areas.size(); ++id) {
+            totals[static_cast<std::size_t>(types[id])] += areas[id];
+        }
+        return totals;
+    }
+
 private:
-    std::string owner;
+    template <typename T>
+    static void buildSortedIndex(const std::vector<T>& column, std::vector<std::uint32_t>& order, std::vector<T>& sorted) {
+        order.resize(column.size());
+        for (std::uint32_t id = 0; id < order.size(); ++id) {
+            order[id] = id;
+        }
+        std::stable_sort(order.begin(), order.end(),
+            [&](std::uint32_t a, std::uint32_t b) { return column[a] < column[b]; });
+        sorted.resize(column.size());
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            sorted[i] = column[order[i]];
+        }
+    }
+
+    template <typename T>
+    static std::pair<std::size_t, std::size_t> range(const std::vector<T>& sorted, T min, T max) {
+        auto first = std::lower_bound(sorted.begin(), sorted.end(), min);
+        auto last = std::upper_bound(first, sorted.end(), max);
+        return { static_cast<std::size_t>(first - sorted.begin()), static_cast<std::size_t>(last - sorted.begin()) };
+    }
+
+    bool matches(std::uint32_t id, const HouseQuery& query) const {
+        return (!query.type || types[id] == *query.type)
+            && floors[id] >= query.minFloors && floors[id] <= query.maxFloors
+            && areas[id] >= query.minArea && areas[id] <= query.maxArea;
+    }
+
+    std::string addressData;
+    std::vector<std::size_t> addressOffsets{ 0 };
+    std::vector<int> floors;
+    std::vector<double> areas;
+    std::vector<HouseType> types;
+    std::vector<std::uint32_t> floorsOrder;
+    std::vector<int> sortedFloors;
+    std::vector<std::uint32_t> areaOrder;
+    std::vector<double> sortedAreas;
+    std::array<std::vector<std::uint64_t>, houseTypeCount> typeBitmaps;
+    std::unordered_map<std::string, std::vector<std::uint32_t>> ownerIndex;
 };
 
+// registerPrototype copies the immutable prototype map under a mutex, changes the
+// copy, publishes it and bumps a version number. Every thread keeps its own reference
+// to the map it last saw and only takes the mutex to reload it when the version has
+// moved, so a lookup is one atomic load with no lock. A prototype returned by a
+// lookup stays valid until the same thread looks up again. Clones into a registry
+// copy the prototype's values into the registry's arena instead of sharing them, so
+// threads cloning the same prototype do not count references on one control block.
 class HousePrototypeFactory {
 public:
+    using PrototypeMap = std::unordered_map<std::string, std::shared_ptr<const House>>;
+
+    HousePrototypeFactory()
+        : prototypes(std::make_shared<const PrototypeMap>()), version(nextVersion.fetch_add(1, std::memory_order_relaxed)) {}
+
     void registerPrototype(const std::string& type, std::unique_ptr<House> prototype) {
-        prototypes[type] = std::move(prototype);
+        std::shared_ptr<const House> shared(std::move(prototype));
+        std::lock_guard<std::mutex> lock(registrationMutex);
+        auto updated = std::make_shared<PrototypeMap>(*prototypes);
+        (*updated)[type] = std::move(shared);
+        prototypes = std::move(updated);
+        version.store(nextVersion.fetch_add(1, std::memory_order_relaxed), std::memory_order_release);
+    }
+
+    std::unique_ptr<House> createHouse(const std::string& type) const {
+        return prototype(type).clone();
+    }
+
+    // The map as currently registered; later registrations do not change it.
+    std::shared_ptr<const PrototypeMap> prototypeSnapshot() const {
+        std::lock_guard<std::mutex> lock(registrationMutex);
+        return prototypes;
+    }
+
+    template <typename Visitor>
+    void forEachPrototype(Visitor&& visitor) const {
+        auto current = prototypeSnapshot();
+        for (const auto& [type, prototype] : *current) {
+            visitor(type, *prototype);
+        }
+    }
+
+    House& createHouse(const std::string& type, HouseRegistry& registry) const {
+        return registry.add(prototype(type));
+    }
+
+    std::span<House* const> createHouses(const std::string& type, std::size_t count, HouseRegistry& registry,
+        const HouseColumns& overrides = {}, unsigned threads = 1) const {
+        return registry.addCopies(prototype(type), count, overrides, threads);
+    }
+
+private:
+    struct CachedSnapshot {
+        std::uint64_t version = 0;
+        std::shared_ptr<const PrototypeMap> prototypes;
+    };
+
+    // Versions are unique across factories, so a cache entry can never be mistaken
+    // for the map of another factory.
+    const PrototypeMap& snapshot() const {
+        thread_local CachedSnapshot cached;
+        std::uint64_t current = version.load(std::memory_order_acquire);
+        if (cached.version != current) {
+            cached.prototypes = prototypeSnapshot();
+            cached.version = current;
+        }
+        return *cached.prototypes;
+    }
+
+    const House& prototype(const std::string& type) const {
+        const PrototypeMap& current = snapshot();
+        auto it = current.find(type);
+        if (it == current.end()) {
+            throw std::invalid_argument("Unknown house type");
+        }
+        return *it->second;
+    }
+
+    inline static std::atomic<std::uint64_t> nextVersion{ 1 };
+
+    std::shared_ptr<const PrototypeMap> prototypes;
+    std::atomic<std::uint64_t> version;
+    mutable std::mutex registrationMutex;
+};
+
+// Clones the given type from 1, 2, 4, ... threads while another thread keeps
+// re-registering the prototype, and prints the clone throughput for each run.
+void benchmarkPrototypeRegistry(HousePrototypeFactory& factory, const std::string& type) {
+    constexpr auto duration = std::chrono::milliseconds(300);
+    const unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    double singleThreadRate = 0.0;
+
+    for (unsigned threads = 1; threads <= maxThreads; threads = (threads * 2 > maxThreads && threads < maxThreads) ? maxThreads : threads * 2) {
+        std::atomic<bool> running{ true };
+        std::atomic<std::uint64_t> totalClones{ 0 };
+        std::atomic<std::uint64_t> registrations{ 0 };
+
+        std::thread admin([&] {
+            while (running.load(std::memory_order_relaxed)) {
+                factory.registerPrototype(type, factory.createHouse(type));
+                registrations.fetch_add(1, std::memory_order_relaxed);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&] {
+                HouseRegistry local;
+                std::uint64_t clones = 0;
+                while (running.load(std::memory_order_relaxed)) {
+                    for (int i = 0; i < 1024; ++i) {
+                        factory.createHouse(type, local);
+                    }
+                    clones += 1024;
+                    if (local.size() >= 64 * 1024) {
+                        local.clear();
+                    }
+                }
+                totalClones.fetch_add(clones, std::memory_order_relaxed);
+            });
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(duration);
+        running = false;
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        admin.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double rate = totalClones.load() / seconds;
+        if (threads == 1) {
+            singleThreadRate = rate;
+        }
+        std::cout << threads << " thread(s): " << static_cast<std::uint64_t>(rate) << " clones/s, speedup "
+            << (singleThreadRate > 0 ? rate / singleThreadRate : 0.0) << "x, "
+            << registrations.load() << " prototype updates\n";
+
+        if (threads == maxThreads) {
+            break;
+        }
+    }
+}
+
+// Snapshot layout, version 1 (integers and doubles in host byte order):
+//   header:     "HSNP", u32 version, u32 prototype count, u64 house count,
+//               u64 offset of the house offset table
+//   prototypes: string type name followed by a house record, repeated
+//   houses:     house records
+//   table:      u64 file offset of every house record
+// A house record is u8 type, i32 floors, f64 area, string address, u32 owner count
+// and the owner strings; a string is a u32 length followed by its bytes.
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(std::string& out) : out(out) {}
+
+    template <typename T>
+    void write(T value) {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        out.append(bytes, sizeof(T));
+    }
+
+    void writeString(std::string_view value) {
+        write(static_cast<std::uint32_t>(value.size()));
+        out.append(value);
+    }
+
+    void writeHouse(const House& house) {
+        write(static_cast<std::uint8_t>(house.type()));
+        write(static_cast<std::int32_t>(house.getFloors()));
+        write(house.getArea());
+        writeString(house.getAddress());
+        auto owners = house.ownerNames();
+        write(static_cast<std::uint32_t>(owners.size()));
+        for (const auto& owner : owners) {
+            writeString(owner);
+        }
+    }
+
+private:
+    std::string& out;
+};
+
+class SnapshotReader {
+public:
+    SnapshotReader(const char* data, std::size_t size, std::size_t offset = 0)
+        : begin(data), position(data + offset), end(data + size) {
+        if (offset > size) {
+            corrupted();
+        }
+    }
+
+    template <typename T>
+    T read() {
+        require(sizeof(T));
+        T value;
+        std::memcpy(&value, position, sizeof(T));
+        position += sizeof(T);
+        return value;
+    }
+
+    std::string_view readString() {
+        auto length = read<std::uint32_t>();
+        require(length);
+        std::string_view value(position, length);
+        position += length;
+        return value;
+    }
+
+    std::unique_ptr<House> readHouse() {
+        auto type = read<std::uint8_t>();
+        auto floors = read<std::int32_t>();
+        auto area = read<double>();
+        std::string address(readString());
+        auto ownerCount = read<std::uint32_t>();
+        if (ownerCount > static_cast<std::size_t>(end - position) / sizeof(std::uint32_t)) {
+            corrupted();
+        }
+        std::vector<std::string> owners;
+        owners.reserve(ownerCount);
+        for (std::uint32_t i = 0; i < ownerCount; ++i) {
+            owners.emplace_back(readString());
+        }
+
+        if (type == static_cast<std::uint8_t>(HouseType::ApartmentBuilding)) {
+            return std::make_unique<ApartmentBuilding>(address, floors, area, owners);
+        }
+        if (type == static_cast<std::uint8_t>(HouseType::Cottage) && owners.size() == 1) {
+            return std::make_unique<Cottage>(address, floors, area, owners.front());
+        }
+        corrupted();
+    }
+
+    std::size_t offset() const { return static_cast<std::size_t>(position - begin); }
+
+    [[noreturn]] static void corrupted() {
+        throw std::runtime_error("Corrupted house snapshot");
+    }
+
+private:
+    void require(std::size_t bytes) const {
+        if (bytes > static_cast<std::size_t>(end - position)) {
+            corrupted();
+        }
+    }
+
+    const char* begin;
+    const char* position;
+    const char* end;
+};
+
+constexpr char snapshotMagic[4] = { 'H', 'S', 'N', 'P' };
+constexpr std::uint32_t snapshotVersion = 1;
+constexpr std::size_t snapshotHeaderSize = 4 + 4 + 4 + 8 + 8;
+
+void saveSnapshot(const std::string& path, const HousePrototypeFactory& factory, const HouseRegistry& houses) {
+    constexpr std::size_t chunkSize = 1 << 20;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Cannot open " + path + " for writing");
+    }
+
+    std::string buffer;
+    SnapshotWriter writer(buffer);
+    std::uint64_t written = 0;
+    auto flush = [&] {
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        written += buffer.size();
+        buffer.clear();
+    };
+
+    // One copy of the map, so the count always matches the records written.
+    auto prototypes = factory.prototypeSnapshot();
+
+    buffer.append(snapshotMagic, sizeof(snapshotMagic));
+    writer.write(snapshotVersion);
+    writer.write(static_cast<std::uint32_t>(prototypes->size()));
+    writer.write(static_cast<std::uint64_t>(houses.size()));
+    writer.write(std::uint64_t{ 0 });
+
+    for (const auto& [type, prototype] : *prototypes) {
+        writer.writeString(type);
+        writer.writeHouse(*prototype);
+    }
+
+    std::vector<std::uint64_t> offsets;
+    offsets.reserve(houses.size());
+    for (std::size_t i = 0; i < houses.size(); ++i) {
+        offsets.push_back(written + buffer.size());
+        writer.writeHouse(houses[i]);
+        if (buffer.size() >= chunkSize) {
+            flush();
+        }
+    }
+
+    const std::uint64_t tableOffset = written + buffer.size();
+    for (std::uint64_t offset : offsets) {
+        writer.write(offset);
+        if (buffer.size() >= chunkSize) {
+            flush();
+        }
+    }
+    flush();
+
+    file.seekp(snapshotHeaderSize - sizeof(tableOffset));
+    file.write(reinterpret_cast<const char*>(&tableOffset), sizeof(tableOffset));
+    file.close();
+    if (!file) {
+        throw std::runtime_error("Failed to write " + path);
+    }
+}
+
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            close();
+            throw std::runtime_error("Cannot read " + path);
+        }
+        length = static_cast<std::size_t>(fileSize.QuadPart);
+        if (length != 0) {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+            if (!view) {
+                close();
+                throw std::runtime_error("Cannot map " + path);
+            }
+        }
+#else
+        descriptor = ::open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        struct stat info;
+        if (::fstat(descriptor, &info) != 0) {
+            close();
+            throw std::runtime_error("Cannot read " + path);
+        }
+        length = static_cast<std::size_t>(info.st_size);
+        if (length != 0) {
+            view = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (view == MAP_FAILED) {
+                view = nullptr;
+                close();
+                throw std::runtime_error("Cannot map " + path);
+            }
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        close();
+    }
+
+    const char* data() const { return static_cast<const char*>(view); }
+    std::size_t size() const { return length; }
+
+private:
+    void close() {
+#ifdef _WIN32
+        if (view) {
+            UnmapViewOfFile(view);
+        }
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        if (file != INVALID_HANDLE_VALUE) {
+            CloseHandle(file);
+        }
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (view) {
+            ::munmap(view, length);
+        }
+        if (descriptor >= 0) {
+            ::close(descriptor);
+        }
+        descriptor = -1;
+#endif
+        view = nullptr;
     }
 
-    std::unique_ptr<House> createHouse(const std::string& type) {
-        if (prototypes.find(type) != prototypes.end()) {
-            return prototypes[type]->clone();
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int descriptor = -1;
+#endif
+    void* view = nullptr;
+    std::size_t length = 0;
+};
+
+// Maps a snapshot file and turns house records into objects on first access. The
+// materialized houses allocate from the default resource, so copies made from them
+// stay valid after the snapshot is closed.
+class HouseSnapshot {
+public:
+    explicit HouseSnapshot(const std::string& path) : file(path) {
+        SnapshotReader reader(file.data(), file.size());
+        if (file.size() < snapshotHeaderSize || std::memcmp(file.data(), snapshotMagic, sizeof(snapshotMagic)) != 0) {
+            throw std::runtime_error("Not a house snapshot: " + path);
+        }
+        reader.read<std::uint32_t>();
+        if (reader.read<std::uint32_t>() != snapshotVersion) {
+            throw std::runtime_error("Unsupported house snapshot version");
+        }
+        prototypeCount = reader.read<std::uint32_t>();
+        auto houseCount = reader.read<std::uint64_t>();
+        tableOffset = reader.read<std::uint64_t>();
+        prototypesOffset = reader.offset();
+        if (tableOffset > file.size() || houseCount > (file.size() - tableOffset) / sizeof(std::uint64_t)) {
+            SnapshotReader::corrupted();
+        }
+        houses.resize(static_cast<std::size_t>(houseCount));
+    }
+
+    std::size_t size() const { return houses.size(); }
+
+    const House& house(std::size_t index) {
+        auto& slot = houses.at(index);
+        if (!slot) {
+            SnapshotReader table(file.data(), file.size(), static_cast<std::size_t>(tableOffset + index * sizeof(std::uint64_t)));
+            SnapshotReader record(file.data(), file.size(), static_cast<std::size_t>(table.read<std::uint64_t>()));
+            slot = record.readHouse();
+        }
+        return *slot;
+    }
+
+    void restorePrototypes(HousePrototypeFactory& factory) const {
+        SnapshotReader reader(file.data(), file.size(), prototypesOffset);
+        for (std::uint32_t i = 0; i < prototypeCount; ++i) {
+            std::string type(reader.readString());
+            factory.registerPrototype(type, reader.readHouse());
+        }
+    }
+
+    void restoreHouses(HouseRegistry& registry) {
+        for (std::size_t i = 0; i < houses.size(); ++i) {
+            registry.add(house(i));
+            houses[i].reset();
         }
-        throw std::invalid_argument("Unknown house type");
     }
 
 private:
-    std::unordered_map<std::string, std::unique_ptr<House>> prototypes;
+    MappedFile file;
+    std::uint32_t prototypeCount = 0;
+    std::size_t prototypesOffset = 0;
+    std::uint64_t tableOffset = 0;
+    std::vector<std::unique_ptr<House>> houses;
 };
 
 int main() {
@@ -130,7 +1070,10 @@ int main() {
     factory.registerPrototype("Cottage",
         std::make_unique<Cottage>("DefaultAddress", 2, 120.0, "DefaultOwner"));
 
-    std::vector<std::unique_ptr<House>> houses;
+    HouseRegistry houses;
+    // Rebuilt on the next search after houses are added or edited.
+    HouseIndex houseIndex;
+    bool indexStale = true;
 
     int choice;
     do {
@@ -139,16 +1082,21 @@ int main() {
             << "2. Add cottage\n"
             << "3. Show all houses\n"
             << "4. Edit house\n"
+            << "5. Add houses in bulk\n"
+            << "6. Search houses\n"
+            << "7. Save snapshot\n"
+            << "8. Load snapshot\n"
+            << "9. Benchmark prototype registry\n"
             << "0. Exit\n"
             << "Choice: ";
         std::cin >> choice;
 
         if (choice == 1 || choice == 2) {
+            indexStale = true;
             try {
                 std::string type = (choice == 1) ? "ApartmentBuilding" : "Cottage";
-                auto house = factory.createHouse(type);
-                house->editInfo();
-                houses.push_back(std::move(house));
+                House& house = factory.createHouse(type, houses);
+                house.editInfo();
             }
             catch (const std::exception& ex) {
                 std::cerr << "Error: " << ex.what() << "\n";
@@ -161,7 +1109,7 @@ int main() {
             else {
                 for (size_t i = 0; i < houses.size(); ++i) {
                     std::cout << "House " << (i + 1) << ":\n";
-                    houses[i]->displayInfo();
+                    houses[i].displayInfo();
                     std::cout << "\n";
                 }
             }
@@ -171,12 +1119,85 @@ int main() {
             size_t index;
             std::cin >> index;
             if (index > 0 && index <= houses.size()) {
-                houses[index - 1]->editInfo();
+                indexStale = true;
+                houses[index - 1].editInfo();
             }
             else {
                 std::cerr << "Invalid house number.\n";
             }
         }
+        else if (choice == 5) {
+            int type;
+            std::size_t count;
+            std::cout << "House type (1 - apartment building, 2 - cottage): ";
+            std::cin >> type;
+            std::cout << "Number of houses: ";
+            std::cin >> count;
+            indexStale = true;
+            try {
+                factory.createHouses(type == 1 ? "ApartmentBuilding" : "Cottage", count, houses, {}, 0);
+                std::cout << "Added " << count << " houses.\n";
+            }
+            catch (const std::exception& ex) {
+                std::cerr << "Error: " << ex.what() << "\n";
+            }
+        }
+        else if (choice == 6) {
+            HouseQuery query;
+            int type;
+            std::string owner;
+            std::cout << "House type (0 - any, 1 - apartment building, 2 - cottage): ";
+            std::cin >> type;
+            if (type == 1 || type == 2) {
+                query.type = (type == 1) ? HouseType::ApartmentBuilding : HouseType::Cottage;
+            }
+            std::cout << "Minimum area: ";
+            std::cin >> query.minArea;
+            std::cout << "Owner (- for any): ";
+            std::cin >> owner;
+            if (owner != "-") {
+                query.owner = owner;
+            }
+
+            if (indexStale) {
+                houseIndex.rebuild(houses);
+                indexStale = false;
+            }
+            auto found = houseIndex.find(query);
+            std::cout << "Found " << found.size() << " house(s):";
+            for (std::size_t i = 0; i < found.size() && i < 20; ++i) {
+                std::cout << " " << (found[i] + 1);
+            }
+            std::cout << (found.size() > 20 ? " ...\n" : "\n");
+
+            auto totals = houseIndex.totalAreaByType();
+            std::cout << "Total area: apartment buildings " << totals[static_cast<std::size_t>(HouseType::ApartmentBuilding)]
+                << " sq.m, cottages " << totals[static_cast<std::size_t>(HouseType::Cottage)] << " sq.m\n";
+        }
+        else if (choice == 7 || choice == 8) {
+            std::string path;
+            std::cout << "Snapshot file: ";
+            std::cin >> path;
+            try {
+                if (choice == 7) {
+                    saveSnapshot(path, factory, houses);
+                    std::cout << "Saved " << houses.size() << " houses.\n";
+                }
+                else {
+                    indexStale = true;
+                    HouseSnapshot snapshot(path);
+                    snapshot.restorePrototypes(factory);
+                    snapshot.restoreHouses(houses);
+                    std::cout << "Loaded " << snapshot.size() << " houses.\n";
+                }
+            }
+            catch (const std::exception& ex) {
+                std::cerr << "Error: " << ex.what() << "\n";
+            }
+        }
+        else if (choice == 9) {
+            benchmarkPrototypeRegistry(factory, "ApartmentBuilding");
+        }
     } while (choice != 0);
 
     return 0;
@@ -3,28 +3,213 @@
 #include <string>
 #include <cmath>
 #include <vector>
+#include <span>
+#include <queue>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+#include <unordered_map>
+#include <string_view>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <fstream>
+#include <thread>
+#include <charconv>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <cctype>
+#include <variant>
+
+// The AVX2 kernels are compiled for every x86 build and chosen at run time, so a
+// binary built for the baseline instruction set still uses them where available.
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define SHAPES_HAS_AVX2_PATH
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#define SHAPES_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define SHAPES_AVX2_TARGET
+#endif
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SHAPES_USE_SSE2
+#endif
+
+#if defined(_WIN32) || defined(__GLIBC__)
+#include <malloc.h>
+#endif
 
 constexpr double g_pi{ 3.1415 };
 
+class ShapeStore;
+
+using ColorId = std::uint16_t;
+
+// Process-wide table of color names. Interning takes a lock; name() is lock-free,
+// because names live in fixed blocks that are published once and never move.
+class ColorPalette {
+public:
+    static ColorPalette& instance() {
+        static ColorPalette palette;
+        return palette;
+    }
+
+    ColorId intern(std::string_view name) {
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            auto it = ids.find(name);
+            if (it != ids.end()) {
+                return it->second;
+            }
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto it = ids.find(name);
+        if (it != ids.end()) {
+            return it->second;
+        }
+        std::size_t id = count.load(std::memory_order_relaxed);
+        if (id >= blockCount * blockSize) {
+            throw std::length_error("Too many distinct colors");
+        }
+        auto& block = blocks[id / blockSize];
+        if (!block.load(std::memory_order_relaxed)) {
+            block.store(new std::string[blockSize], std::memory_order_release);
+        }
+        std::string& slot = block.load(std::memory_order_relaxed)[id % blockSize];
+        slot = name;
+        ids.emplace(slot, static_cast<ColorId>(id));
+        count.store(id + 1, std::memory_order_release);
+        return static_cast<ColorId>(id);
+    }
+
+    std::string_view name(ColorId id) const {
+        return blocks[id / blockSize].load(std::memory_order_acquire)[id % blockSize];
+    }
+
+    std::size_t size() const {
+        return count.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr std::size_t blockSize = 256;
+    static constexpr std::size_t blockCount = 256;
+
+    ColorPalette() = default;
+    ~ColorPalette() {
+        for (auto& block : blocks) {
+            delete[] block.load();
+        }
+    }
+
+    std::array<std::atomic<std::string*>, blockCount> blocks{};
+    std::atomic<std::size_t> count{ 0 };
+    std::unordered_map<std::string_view, ColorId> ids;
+    mutable std::shared_mutex mutex;
+};
+
+struct BoundingBox {
+    double minX, minY, maxX, maxY;
+
+    bool intersects(const BoundingBox& other) const {
+        return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+    }
+
+    double distanceSquared(double x, double y) const {
+        double dx = std::max({ minX - x, 0.0, x - maxX });
+        double dy = std::max({ minY - y, 0.0, y - maxY });
+        return dx * dx + dy * dy;
+    }
+};
+
+enum class ShapeKind : std::uint8_t {
+    Circle,
+    Rectangle,
+    Triangle,
+};
+
+// Parsed form of a shape: a and b are radius/radius, width/height or base/height.
+struct ShapeRecord {
+    ShapeKind kind;
+    double x, y, a, b;
+    ColorId color;
+};
+
+struct BoundingCircle {
+    double x, y, radius;
+};
+
+// Smallest circle enclosing the shape. Triangles are isosceles with a horizontal
+// base at the bottom of their box and the apex at the top middle; a triangle that
+// is obtuse at the apex is enclosed by the circle over its base, otherwise by its
+// circumcircle.
+inline BoundingCircle boundingCircleOf(const ShapeRecord& record) {
+    switch (record.kind) {
+    case ShapeKind::Circle:
+        return { record.x, record.y, record.a };
+    case ShapeKind::Rectangle:
+        return { record.x, record.y, std::hypot(record.a, record.b) / 2 };
+    default: {
+        double halfBase = record.a / 2;
+        double height = record.b;
+        double baseY = record.y - height / 2;
+        if (height <= halfBase) {
+            return { record.x, baseY, halfBase };
+        }
+        double offset = (height * height - halfBase * halfBase) / (2 * height);
+        return { record.x, baseY + offset, height - offset };
+    }
+    }
+}
+
+inline BoundingBox boundingBoxOf(const ShapeRecord& record) {
+    double halfWidth = record.kind == ShapeKind::Circle ? record.a : record.a / 2;
+    double halfHeight = record.kind == ShapeKind::Circle ? record.a : record.b / 2;
+    return { record.x - halfWidth, record.y - halfHeight, record.x + halfWidth, record.y + halfHeight };
+}
+
 class Shape {
 public:
     virtual ~Shape() = default;
     virtual double area() const = 0;
-    virtual std::string color() const = 0;
+    virtual std::string_view color() const = 0;
+    virtual ColorId colorId() const = 0;
     virtual std::pair<double, double> boundingCircleCenter() const = 0;
+    virtual BoundingCircle boundingCircle() const = 0;
+    virtual BoundingBox boundingBox() const = 0;
     virtual void display() const = 0;
+    virtual void appendTo(ShapeStore& store) const = 0;
+    virtual ShapeRecord record() const = 0;
 };
 
-class Circle : public Shape {
+class Circle final : public Shape {
 public:
-    Circle(double x, double y, double r, const std::string& c)
+    Circle(double x, double y, double r, ColorId c)
         : centerX(x), centerY(y), radius(r), shapeColor(c) {}
+    explicit Circle(const ShapeRecord& record)
+        : Circle(record.x, record.y, record.a, record.color) {}
+    Circle(double x, double y, double r, std::string_view c)
+        : Circle(x, y, r, ColorPalette::instance().intern(c)) {}
 
     double area() const override {
         return g_pi * radius * radius;
     }
 
-    std::string color() const override {
+    std::string_view color() const override {
+        return ColorPalette::instance().name(shapeColor);
+    }
+
+    ColorId colorId() const override {
         return shapeColor;
     }
 
@@ -32,26 +217,48 @@ public:
         return { centerX, centerY };
     }
 
+    BoundingCircle boundingCircle() const override {
+        return { centerX, centerY, radius };
+    }
+
+    BoundingBox boundingBox() const override {
+        return { centerX - radius, centerY - radius, centerX + radius, centerY + radius };
+    }
+
     void display() const override {
         std::cout << "Circle: center=(" << centerX << ", " << centerY
-            << "), radius=" << radius << ", color=" << shapeColor << "\n";
+            << "), radius=" << radius << ", color=" << color() << "\n";
+    }
+
+    void appendTo(ShapeStore& store) const override;
+
+    ShapeRecord record() const override {
+        return { ShapeKind::Circle, centerX, centerY, radius, radius, shapeColor };
     }
 
 private:
     double centerX, centerY, radius;
-    std::string shapeColor;
+    ColorId shapeColor;
 };
 
-class Rectangle : public Shape {
+class Rectangle final : public Shape {
 public:
-    Rectangle(double x, double y, double w, double h, const std::string& c)
+    Rectangle(double x, double y, double w, double h, ColorId c)
         : centerX(x), centerY(y), width(w), height(h), shapeColor(c) {}
+    explicit Rectangle(const ShapeRecord& record)
+        : Rectangle(record.x, record.y, record.a, record.b, record.color) {}
+    Rectangle(double x, double y, double w, double h, std::string_view c)
+        : Rectangle(x, y, w, h, ColorPalette::instance().intern(c)) {}
 
     double area() const override {
         return width * height;
     }
 
-    std::string color() const override {
+    std::string_view color() const override {
+        return ColorPalette::instance().name(shapeColor);
+    }
+
+    ColorId colorId() const override {
         return shapeColor;
     }
 
@@ -59,49 +266,803 @@ public:
         return { centerX, centerY };
     }
 
+    BoundingCircle boundingCircle() const override {
+        return { centerX, centerY, std::hypot(width, height) / 2 };
+    }
+
+    BoundingBox boundingBox() const override {
+        return { centerX - width / 2, centerY - height / 2, centerX + width / 2, centerY + height / 2 };
+    }
+
     void display() const override {
         std::cout << "Rectangle: center=(" << centerX << ", " << centerY
             << "), width=" << width << ", height=" << height
-            << ", color=" << shapeColor << "\n";
+            << ", color=" << color() << "\n";
+    }
+
+    void appendTo(ShapeStore& store) const override;
+
+    ShapeRecord record() const override {
+        return { ShapeKind::Rectangle, centerX, centerY, width, height, shapeColor };
     }
 
 private:
     double centerX, centerY, width, height;
-    std::string shapeColor;
+    ColorId shapeColor;
 };
 
-class Triangle : public Shape {
+class Triangle final : public Shape {
 public:
-    Triangle(double x, double y, double base, double height, const std::string& c)
+    Triangle(double x, double y, double base, double height, ColorId c)
         : centerX(x), centerY(y), baseLength(base), heightLength(height), shapeColor(c) {}
+    explicit Triangle(const ShapeRecord& record)
+        : Triangle(record.x, record.y, record.a, record.b, record.color) {}
+    Triangle(double x, double y, double base, double height, std::string_view c)
+        : Triangle(x, y, base, height, ColorPalette::instance().intern(c)) {}
 
     double area() const override {
         return 0.5 * baseLength * heightLength;
     }
 
-    std::string color() const override {
+    std::string_view color() const override {
+        return ColorPalette::instance().name(shapeColor);
+    }
+
+    ColorId colorId() const override {
         return shapeColor;
     }
 
     std::pair<double, double> boundingCircleCenter() const override {
-        return { centerX, centerY };
+        BoundingCircle circle = boundingCircle();
+        return { circle.x, circle.y };
+    }
+
+    BoundingCircle boundingCircle() const override {
+        return boundingCircleOf(record());
+    }
+
+    // The triangle is isosceles with a horizontal base; (centerX, centerY) is the
+    // middle of the box spanned by the base and the apex.
+    BoundingBox boundingBox() const override {
+        return { centerX - baseLength / 2, centerY - heightLength / 2, centerX + baseLength / 2, centerY + heightLength / 2 };
     }
 
     void display() const override {
         std::cout << "Triangle: center=(" << centerX << ", " << centerY
             << "), base=" << baseLength << ", height=" << heightLength
-            << ", color=" << shapeColor << "\n";
+            << ", color=" << color() << "\n";
+    }
+
+    void appendTo(ShapeStore& store) const override;
+
+    ShapeRecord record() const override {
+        return { ShapeKind::Triangle, centerX, centerY, baseLength, heightLength, shapeColor };
     }
 
 private:
     double centerX, centerY, baseLength, heightLength;
-    std::string shapeColor;
+    ColorId shapeColor;
+};
+
+#if defined(SHAPES_HAS_AVX2_PATH)
+inline bool cpuSupportsAvx2() {
+#if defined(__AVX2__)
+    return true;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    // The OS must also save the YMM registers on context switches.
+    if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+inline bool avx2Available() {
+    static const bool available = cpuSupportsAvx2();
+    return available;
+}
+
+// The kernels below handle whole vectors only and return how many elements they did.
+SHAPES_AVX2_TARGET inline std::size_t scaledProductsAvx2(const double* a, const double* b, double scale, double* out,
+    std::size_t count) {
+    std::size_t i = 0;
+    const __m256d factor = _mm256_set1_pd(scale);
+    for (; i + 4 <= count; i += 4) {
+        __m256d product = _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i));
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(product, factor));
+    }
+    return i;
+}
+
+SHAPES_AVX2_TARGET inline std::size_t dotProductAvx2(const double* a, const double* b, std::size_t count, double& total) {
+    std::size_t i = 0;
+    __m256d sum0 = _mm256_setzero_pd();
+    __m256d sum1 = _mm256_setzero_pd();
+    for (; i + 8 <= count; i += 8) {
+        sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(sum0, sum1));
+    total += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    return i;
+}
+#endif
+
+#if defined(SHAPES_USE_SSE2)
+inline std::size_t scaledProductsSse2(const double* a, const double* b, double scale, double* out, std::size_t count) {
+    std::size_t i = 0;
+    const __m128d factor = _mm_set1_pd(scale);
+    for (; i + 2 <= count; i += 2) {
+        __m128d product = _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i));
+        _mm_storeu_pd(out + i, _mm_mul_pd(product, factor));
+    }
+    return i;
+}
+
+inline std::size_t dotProductSse2(const double* a, const double* b, std::size_t count, double& total) {
+    std::size_t i = 0;
+    __m128d sum0 = _mm_setzero_pd();
+    __m128d sum1 = _mm_setzero_pd();
+    for (; i + 4 <= count; i += 4) {
+        sum0 = _mm_add_pd(sum0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        sum1 = _mm_add_pd(sum1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, _mm_add_pd(sum0, sum1));
+    total += lanes[0] + lanes[1];
+    return i;
+}
+#endif
+
+// out[i] = scale * a[i] * b[i]; every shape area has this form.
+inline void scaledProducts(const double* a, const double* b, double scale, double* out, std::size_t count) {
+    std::size_t i = 0;
+#if defined(SHAPES_HAS_AVX2_PATH)
+    if (avx2Available()) {
+        i = scaledProductsAvx2(a, b, scale, out, count);
+    }
+#endif
+#if defined(SHAPES_USE_SSE2)
+    i += scaledProductsSse2(a + i, b + i, scale, out + i, count - i);
+#endif
+    for (; i < count; ++i) {
+        out[i] = scale * a[i] * b[i];
+    }
+}
+
+// scale * sum(a[i] * b[i]), accumulated in several independent lanes.
+inline double scaledDotProduct(const double* a, const double* b, double scale, std::size_t count) {
+    std::size_t i = 0;
+    double total = 0.0;
+#if defined(SHAPES_HAS_AVX2_PATH)
+    if (avx2Available()) {
+        i = dotProductAvx2(a, b, count, total);
+    }
+#endif
+#if defined(SHAPES_USE_SSE2)
+    i += dotProductSse2(a + i, b + i, count - i, total);
+#endif
+    for (; i < count; ++i) {
+        total += a[i] * b[i];
+    }
+    return scale * total;
+}
+
+// Structure-of-arrays copy of a shape collection: one set of columns per shape
+// kind, so area work runs over contiguous doubles instead of virtual calls.
+class ShapeStore {
+public:
+    void addCircle(double x, double y, double radius, ColorId color) {
+        circles.x.push_back(x);
+        circles.y.push_back(y);
+        circles.a.push_back(radius);
+        circles.b.push_back(radius);
+        circles.color.push_back(color);
+    }
+
+    void addRectangle(double x, double y, double width, double height, ColorId color) {
+        rectangles.x.push_back(x);
+        rectangles.y.push_back(y);
+        rectangles.a.push_back(width);
+        rectangles.b.push_back(height);
+        rectangles.color.push_back(color);
+    }
+
+    void addTriangle(double x, double y, double base, double height, ColorId color) {
+        triangles.x.push_back(x);
+        triangles.y.push_back(y);
+        triangles.a.push_back(base);
+        triangles.b.push_back(height);
+        triangles.color.push_back(color);
+    }
+
+    void add(const Shape& shape) {
+        shape.appendTo(*this);
+    }
+
+    std::size_t size() const {
+        return circles.size() + rectangles.size() + triangles.size();
+    }
+
+    // Circles first, then rectangles, then triangles, each in insertion order.
+    std::vector<double> areas() const {
+        std::vector<double> result(size());
+        double* out = result.data();
+        for (const auto* columns : { &circles, &rectangles, &triangles }) {
+            scaledProducts(columns->a.data(), columns->b.data(), scaleOf(*columns), out, columns->size());
+            out += columns->size();
+        }
+        return result;
+    }
+
+    double totalArea() const {
+        double total = 0.0;
+        for (const auto* columns : { &circles, &rectangles, &triangles }) {
+            total += scaledDotProduct(columns->a.data(), columns->b.data(), scaleOf(*columns), columns->size());
+        }
+        return total;
+    }
+
+    // Indexed by ColorId.
+    std::vector<double> areaByColor() const {
+        constexpr std::size_t blockSize = 1024;
+        std::vector<double> totals(ColorPalette::instance().size(), 0.0);
+        double block[blockSize];
+        for (const auto* columns : { &circles, &rectangles, &triangles }) {
+            const double scale = scaleOf(*columns);
+            for (std::size_t first = 0; first < columns->size(); first += blockSize) {
+                std::size_t count = std::min(blockSize, columns->size() - first);
+                scaledProducts(columns->a.data() + first, columns->b.data() + first, scale, block, count);
+                for (std::size_t i = 0; i < count; ++i) {
+                    totals[columns->color[first + i]] += block[i];
+                }
+            }
+        }
+        return totals;
+    }
+
+private:
+    // a and b are the two dimensions whose scaled product is the area.
+    struct Columns {
+        std::vector<double> x, y, a, b;
+        std::vector<ColorId> color;
+
+        std::size_t size() const { return x.size(); }
+    };
+
+    double scaleOf(const Columns& columns) const {
+        if (&columns == &circles) {
+            return g_pi;
+        }
+        return &columns == &triangles ? 0.5 : 1.0;
+    }
+
+    Columns circles;
+    Columns rectangles;
+    Columns triangles;
+};
+
+void Circle::appendTo(ShapeStore& store) const {
+    store.addCircle(centerX, centerY, radius, shapeColor);
+}
+
+void Rectangle::appendTo(ShapeStore& store) const {
+    store.addRectangle(centerX, centerY, width, height, shapeColor);
+}
+
+void Triangle::appendTo(ShapeStore& store) const {
+    store.addTriangle(centerX, centerY, baseLength, heightLength, shapeColor);
+}
+
+// Exact intersection tests on the outlines described by shape records. Touching
+// shapes count as overlapping.
+class ShapeGeometry {
+public:
+    explicit ShapeGeometry(const ShapeRecord& record) {
+        double halfA = record.a / 2;
+        double halfB = record.b / 2;
+        switch (record.kind) {
+        case ShapeKind::Circle:
+            isCircle = true;
+            centerX = record.x;
+            centerY = record.y;
+            radius = record.a;
+            break;
+        case ShapeKind::Rectangle:
+            vertexCount = 4;
+            vertices = { { { record.x - halfA, record.y - halfB }, { record.x + halfA, record.y - halfB },
+                { record.x + halfA, record.y + halfB }, { record.x - halfA, record.y + halfB } } };
+            break;
+        default:
+            vertexCount = 3;
+            vertices = { { { record.x - halfA, record.y - halfB }, { record.x + halfA, record.y - halfB },
+                { record.x, record.y + halfB } } };
+            break;
+        }
+    }
+
+    bool overlaps(const ShapeGeometry& other) const {
+        if (isCircle && other.isCircle) {
+            double dx = centerX - other.centerX;
+            double dy = centerY - other.centerY;
+            double reach = radius + other.radius;
+            return dx * dx + dy * dy <= reach * reach;
+        }
+        if (isCircle) {
+            return other.overlapsCircle(centerX, centerY, radius);
+        }
+        if (other.isCircle) {
+            return overlapsCircle(other.centerX, other.centerY, other.radius);
+        }
+        return !separatedAlongEdges(other) && !other.separatedAlongEdges(*this);
+    }
+
+private:
+    using Point = std::pair<double, double>;
+
+    bool contains(double x, double y) const {
+        for (int i = 0; i < vertexCount; ++i) {
+            const Point& a = vertices[i];
+            const Point& b = vertices[(i + 1) % vertexCount];
+            if ((b.first - a.first) * (y - a.second) - (b.second - a.second) * (x - a.first) < 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool overlapsCircle(double x, double y, double r) const {
+        if (contains(x, y)) {
+            return true;
+        }
+        for (int i = 0; i < vertexCount; ++i) {
+            const Point& a = vertices[i];
+            const Point& b = vertices[(i + 1) % vertexCount];
+            double ex = b.first - a.first, ey = b.second - a.second;
+            double length = ex * ex + ey * ey;
+            double t = length > 0 ? std::clamp(((x - a.first) * ex + (y - a.second) * ey) / length, 0.0, 1.0) : 0.0;
+            double dx = a.first + t * ex - x, dy = a.second + t * ey - y;
+            if (dx * dx + dy * dy <= r * r) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Separating axis test over this polygon's edge normals (vertices are counter-clockwise).
+    bool separatedAlongEdges(const ShapeGeometry& other) const {
+        for (int i = 0; i < vertexCount; ++i) {
+            const Point& a = vertices[i];
+            const Point& b = vertices[(i + 1) % vertexCount];
+            double nx = b.second - a.second, ny = a.first - b.first;
+            double limit = nx * a.first + ny * a.second;
+            bool allOutside = true;
+            for (int j = 0; j < other.vertexCount && allOutside; ++j) {
+                allOutside = nx * other.vertices[j].first + ny * other.vertices[j].second > limit;
+            }
+            if (allOutside) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool isCircle = false;
+    double centerX = 0.0, centerY = 0.0, radius = 0.0;
+    int vertexCount = 0;
+    std::array<Point, 4> vertices{};
+};
+
+// All overlapping pairs (lower index first, sorted). Broad phase: sweep and prune
+// over boxes sorted by minX, split across threads, with a bounding-circle check
+// before the exact test.
+std::vector<std::pair<std::uint32_t, std::uint32_t>> findOverlaps(std::span<const ShapeRecord> records, unsigned threads = 0) {
+    struct Entry {
+        BoundingBox box;
+        BoundingCircle circle;
+        std::uint32_t id;
+    };
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::vector<Entry> entries(records.size());
+    for (std::uint32_t id = 0; id < records.size(); ++id) {
+        entries[id] = { boundingBoxOf(records[id]), boundingCircleOf(records[id]), id };
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.box.minX < b.box.minX; });
+
+    constexpr std::size_t chunkSize = 1 << 14;
+    const std::size_t chunks = (entries.size() + chunkSize - 1) / chunkSize;
+    std::vector<std::vector<std::pair<std::uint32_t, std::uint32_t>>> found(chunks);
+    std::atomic<std::size_t> next{ 0 };
+
+    auto worker = [&] {
+        for (std::size_t chunk = next++; chunk < chunks; chunk = next++) {
+            std::size_t last = std::min(entries.size(), (chunk + 1) * chunkSize);
+            for (std::size_t i = chunk * chunkSize; i < last; ++i) {
+                const Entry& a = entries[i];
+                for (std::size_t j = i + 1; j < entries.size() && entries[j].box.minX <= a.box.maxX; ++j) {
+                    const Entry& b = entries[j];
+                    if (b.box.minY > a.box.maxY || a.box.minY > b.box.maxY) {
+                        continue;
+                    }
+                    double dx = a.circle.x - b.circle.x, dy = a.circle.y - b.circle.y;
+                    double reach = a.circle.radius + b.circle.radius;
+                    if (dx * dx + dy * dy > reach * reach) {
+                        continue;
+                    }
+                    if (ShapeGeometry(records[a.id]).overlaps(ShapeGeometry(records[b.id]))) {
+                        found[chunk].emplace_back(std::min(a.id, b.id), std::max(a.id, b.id));
+                    }
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads && t < chunks; ++t) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> pairs;
+    for (auto& part : found) {
+        pairs.insert(pairs.end(), part.begin(), part.end());
+    }
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+}
+
+struct ColorStats {
+    std::size_t count = 0;
+    double totalArea = 0.0;
+    BoundingBox extent{ std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+        -std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity() };
+};
+
+// One pass over the collection; the result is indexed by ColorId.
+std::vector<ColorStats> aggregateByColor(const std::vector<std::unique_ptr<Shape>>& shapes) {
+    std::vector<ColorStats> stats(ColorPalette::instance().size());
+    for (const auto& shape : shapes) {
+        ColorStats& entry = stats[shape->colorId()];
+        BoundingBox box = shape->boundingBox();
+        ++entry.count;
+        entry.totalArea += shape->area();
+        entry.extent.minX = std::min(entry.extent.minX, box.minX);
+        entry.extent.minY = std::min(entry.extent.minY, box.minY);
+        entry.extent.maxX = std::max(entry.extent.maxX, box.maxX);
+        entry.extent.maxY = std::max(entry.extent.maxY, box.maxY);
+    }
+    return stats;
+}
+
+// Value-semantic alternative to std::vector<std::unique_ptr<Shape>>: the shapes are
+// stored inline and std::visit dispatches to the final classes without a vtable
+// lookup or a pointer chase.
+using ShapeValue = std::variant<Circle, Rectangle, Triangle>;
+
+inline double area(const ShapeValue& shape) {
+    return std::visit([](const auto& value) { return value.area(); }, shape);
+}
+
+inline BoundingBox boundingBox(const ShapeValue& shape) {
+    return std::visit([](const auto& value) { return value.boundingBox(); }, shape);
+}
+
+inline BoundingCircle boundingCircle(const ShapeValue& shape) {
+    return std::visit([](const auto& value) { return value.boundingCircle(); }, shape);
+}
+
+inline void display(const ShapeValue& shape) {
+    std::visit([](const auto& value) { value.display(); }, shape);
+}
+
+class ShapeCollection {
+public:
+    void reserve(std::size_t count) {
+        shapes.reserve(count);
+    }
+
+    template <typename T>
+    void add(const T& shape) requires std::is_constructible_v<ShapeValue, const T&> {
+        shapes.emplace_back(shape);
+    }
+
+    void add(const ShapeRecord& record) {
+        switch (record.kind) {
+        case ShapeKind::Circle:
+            shapes.emplace_back(std::in_place_type<Circle>, record);
+            break;
+        case ShapeKind::Rectangle:
+            shapes.emplace_back(std::in_place_type<Rectangle>, record);
+            break;
+        default:
+            shapes.emplace_back(std::in_place_type<Triangle>, record);
+            break;
+        }
+    }
+
+    std::size_t size() const {
+        return shapes.size();
+    }
+
+    std::size_t memoryUsage() const {
+        return shapes.capacity() * sizeof(ShapeValue);
+    }
+
+    double totalArea() const {
+        double total = 0.0;
+        for (const auto& shape : shapes) {
+            total += area(shape);
+        }
+        return total;
+    }
+
+    BoundingBox bounds() const {
+        BoundingBox result{ std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+            -std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity() };
+        for (const auto& shape : shapes) {
+            BoundingBox box = boundingBox(shape);
+            result.minX = std::min(result.minX, box.minX);
+            result.minY = std::min(result.minY, box.minY);
+            result.maxX = std::max(result.maxX, box.maxX);
+            result.maxY = std::max(result.maxY, box.maxY);
+        }
+        return result;
+    }
+
+    void display() const {
+        for (const auto& shape : shapes) {
+            ::display(shape);
+        }
+    }
+
+    template <typename Visitor>
+    void forEach(Visitor&& visitor) const {
+        for (const auto& shape : shapes) {
+            std::visit(visitor, shape);
+        }
+    }
+
+    const ShapeValue& operator[](std::size_t index) const {
+        return shapes[index];
+    }
+
+private:
+    std::vector<ShapeValue> shapes;
+};
+
+// Uniform grid over shape bounding boxes. Every shape is bucketed by the cell of
+// its box center; queries widen their search by the largest half-extent seen, so a
+// few very large shapes make queries slower but never wrong. Ids are positions in
+// the loaded collection, followed by inserted shapes in insertion order.
+class ShapeGridIndex {
+public:
+    void bulkLoad(std::span<const BoundingBox> shapeBoxes) {
+        boxes.assign(shapeBoxes.begin(), shapeBoxes.end());
+        overflow.clear();
+        overflowCount = 0;
+        maxHalfWidth = maxHalfHeight = 0.0;
+
+        bounds = { 0.0, 0.0, 0.0, 0.0 };
+        if (!boxes.empty()) {
+            bounds = boxes.front();
+        }
+        for (const auto& box : boxes) {
+            bounds.minX = std::min(bounds.minX, box.minX);
+            bounds.minY = std::min(bounds.minY, box.minY);
+            bounds.maxX = std::max(bounds.maxX, box.maxX);
+            bounds.maxY = std::max(bounds.maxY, box.maxY);
+            maxHalfWidth = std::max(maxHalfWidth, (box.maxX - box.minX) / 2);
+            maxHalfHeight = std::max(maxHalfHeight, (box.maxY - box.minY) / 2);
+        }
+
+        double width = std::max(bounds.maxX - bounds.minX, 1e-9);
+        double height = std::max(bounds.maxY - bounds.minY, 1e-9);
+        double targetCells = std::clamp(static_cast<double>(boxes.size()) / 2.0, 1.0, 16777216.0);
+        cellSize = std::sqrt(width * height / targetCells);
+        cellSize = std::max({ cellSize, width / 4096.0, height / 4096.0 });
+        columns = static_cast<int>(std::min(width / cellSize, 4096.0)) + 1;
+        rows = static_cast<int>(std::min(height / cellSize, 4096.0)) + 1;
+
+        std::vector<std::uint32_t> counts(static_cast<std::size_t>(columns) * rows + 1, 0);
+        for (const auto& box : boxes) {
+            ++counts[cellOf(box)];
+        }
+        cellStart.assign(counts.size(), 0);
+        for (std::size_t cell = 1; cell < counts.size(); ++cell) {
+            cellStart[cell] = cellStart[cell - 1] + counts[cell - 1];
+        }
+        cellItems.resize(boxes.size());
+        std::vector<std::uint32_t> cursor(cellStart.begin(), cellStart.end() - 1);
+        for (std::uint32_t id = 0; id < boxes.size(); ++id) {
+            cellItems[cursor[cellOf(boxes[id])]++] = id;
+        }
+    }
+
+    void bulkLoad(const std::vector<std::unique_ptr<Shape>>& shapes) {
+        std::vector<BoundingBox> shapeBoxes;
+        shapeBoxes.reserve(shapes.size());
+        for (const auto& shape : shapes) {
+            shapeBoxes.push_back(shape->boundingBox());
+        }
+        bulkLoad(shapeBoxes);
+    }
+
+    // Appends a shape with the next id. Inserts after a bulk load go to per-cell
+    // overflow lists; the grid is rebuilt once they outnumber the bulk-loaded shapes.
+    std::uint32_t insert(const BoundingBox& box) {
+        auto id = static_cast<std::uint32_t>(boxes.size());
+        boxes.push_back(box);
+        if (cellStart.empty() || overflowCount >= std::max<std::size_t>(cellItems.size(), 1024)) {
+            compact();
+            return id;
+        }
+        maxHalfWidth = std::max(maxHalfWidth, (box.maxX - box.minX) / 2);
+        maxHalfHeight = std::max(maxHalfHeight, (box.maxY - box.minY) / 2);
+        overflow[cellOf(box)].push_back(id);
+        ++overflowCount;
+        return id;
+    }
+
+    std::uint32_t insert(const Shape& shape) {
+        return insert(shape.boundingBox());
+    }
+
+    std::vector<std::uint32_t> query(const BoundingBox& window) const {
+        std::vector<std::uint32_t> result;
+        if (cellStart.empty()) {
+            return result;
+        }
+        int firstColumn = columnOf(window.minX - maxHalfWidth);
+        int lastColumn = columnOf(window.maxX + maxHalfWidth);
+        int firstRow = rowOf(window.minY - maxHalfHeight);
+        int lastRow = rowOf(window.maxY + maxHalfHeight);
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int column = firstColumn; column <= lastColumn; ++column) {
+                forEachInCell(cellIndex(column, row), [&](std::uint32_t id) {
+                    if (boxes[id].intersects(window)) {
+                        result.push_back(id);
+                    }
+                });
+            }
+        }
+        return result;
+    }
+
+    // Ids of the k shapes whose bounding boxes are closest to (x, y), nearest first.
+    std::vector<std::uint32_t> nearest(double x, double y, std::size_t k) const {
+        std::vector<std::uint32_t> result;
+        if (cellStart.empty() || k == 0) {
+            return result;
+        }
+
+        using Candidate = std::pair<double, std::uint32_t>;
+        std::priority_queue<Candidate> best;
+        const int column = columnOf(x);
+        const int row = rowOf(y);
+        const int maxRing = std::max({ column, columns - 1 - column, row, rows - 1 - row });
+        const double reach = std::max(maxHalfWidth, maxHalfHeight);
+
+        auto visit = [&](int c, int r) {
+            if (c < 0 || r < 0 || c >= columns || r >= rows) {
+                return;
+            }
+            forEachInCell(cellIndex(c, r), [&](std::uint32_t id) {
+                double distance = boxes[id].distanceSquared(x, y);
+                if (best.size() < k) {
+                    best.emplace(distance, id);
+                }
+                else if (distance < best.top().first) {
+                    best.pop();
+                    best.emplace(distance, id);
+                }
+            });
+        };
+
+        for (int ring = 0; ring <= maxRing; ++ring) {
+            double lowerBound = (ring - 1) * cellSize - reach;
+            if (best.size() == k && lowerBound > 0 && lowerBound * lowerBound > best.top().first) {
+                break;
+            }
+            if (ring == 0) {
+                visit(column, row);
+                continue;
+            }
+            for (int c = column - ring; c <= column + ring; ++c) {
+                visit(c, row - ring);
+                visit(c, row + ring);
+            }
+            for (int r = row - ring + 1; r <= row + ring - 1; ++r) {
+                visit(column - ring, r);
+                visit(column + ring, r);
+            }
+        }
+
+        result.resize(best.size());
+        for (std::size_t i = result.size(); i-- > 0;) {
+            result[i] = best.top().second;
+            best.pop();
+        }
+        return result;
+    }
+
+    std::size_t size() const { return cellItems.size() + overflowCount; }
+
+private:
+    void compact() {
+        std::vector<BoundingBox> all = std::move(boxes);
+        bulkLoad(all);
+    }
+
+    template <typename Visitor>
+    void forEachInCell(std::size_t cell, Visitor&& visitor) const {
+        for (std::uint32_t i = cellStart[cell]; i < cellStart[cell + 1]; ++i) {
+            visitor(cellItems[i]);
+        }
+        if (overflowCount != 0) {
+            auto it = overflow.find(cell);
+            if (it != overflow.end()) {
+                for (std::uint32_t id : it->second) {
+                    visitor(id);
+                }
+            }
+        }
+    }
+
+    int columnOf(double x) const {
+        double column = std::floor((x - bounds.minX) / cellSize);
+        return static_cast<int>(std::clamp(column, 0.0, static_cast<double>(columns - 1)));
+    }
+
+    int rowOf(double y) const {
+        double row = std::floor((y - bounds.minY) / cellSize);
+        return static_cast<int>(std::clamp(row, 0.0, static_cast<double>(rows - 1)));
+    }
+
+    std::size_t cellIndex(int column, int row) const {
+        return static_cast<std::size_t>(row) * columns + column;
+    }
+
+    std::size_t cellOf(const BoundingBox& box) const {
+        return cellIndex(columnOf((box.minX + box.maxX) / 2), rowOf((box.minY + box.maxY) / 2));
+    }
+
+    BoundingBox bounds{ 0.0, 0.0, 0.0, 0.0 };
+    double cellSize = 1.0;
+    int columns = 0;
+    int rows = 0;
+    double maxHalfWidth = 0.0;
+    double maxHalfHeight = 0.0;
+    std::vector<BoundingBox> boxes;
+    std::vector<std::uint32_t> cellStart;
+    std::vector<std::uint32_t> cellItems;
+    std::unordered_map<std::size_t, std::vector<std::uint32_t>> overflow;
+    std::size_t overflowCount = 0;
 };
 
 class ShapeFactory {
 public:
     virtual ~ShapeFactory() = default;
     virtual std::unique_ptr<Shape> createShape() const = 0;
+    virtual std::unique_ptr<Shape> createShape(const ShapeRecord& record) const = 0;
+
+    static const ShapeFactory& forKind(ShapeKind kind);
 };
 
 class CircleFactory : public ShapeFactory {
@@ -117,6 +1078,10 @@ public:
         std::cin >> color;
         return std::make_unique<Circle>(x, y, r, color);
     }
+
+    std::unique_ptr<Shape> createShape(const ShapeRecord& record) const override {
+        return std::make_unique<Circle>(record);
+    }
 };
 
 class RectangleFactory : public ShapeFactory {
@@ -132,6 +1097,10 @@ public:
         std::cin >> color;
         return std::make_unique<Rectangle>(x, y, w, h, color);
     }
+
+    std::unique_ptr<Shape> createShape(const ShapeRecord& record) const override {
+        return std::make_unique<Rectangle>(record);
+    }
 };
 
 class TriangleFactory : public ShapeFactory {
@@ -147,11 +1116,563 @@ public:
         std::cin >> color;
         return std::make_unique<Triangle>(x, y, base, height, color);
     }
+
+    std::unique_ptr<Shape> createShape(const ShapeRecord& record) const override {
+        return std::make_unique<Triangle>(record);
+    }
+};
+
+const ShapeFactory& ShapeFactory::forKind(ShapeKind kind) {
+    static const CircleFactory circleFactory;
+    static const RectangleFactory rectangleFactory;
+    static const TriangleFactory triangleFactory;
+    switch (kind) {
+    case ShapeKind::Circle: return circleFactory;
+    case ShapeKind::Rectangle: return rectangleFactory;
+    default: return triangleFactory;
+    }
+}
+
+// Scene files come in two formats.
+// Text: one shape per line, "circle x y radius color", "rectangle x y width height color"
+// or "triangle x y base height color"; blank lines and lines starting with '#' are skipped.
+// Binary: "SHPB", u32 version, u32 color count, colors as u16 length + bytes, u64 shape
+// count, then per shape u8 kind, f64 x, y, a, b and u16 index into the color list.
+// Binary values are in host byte order.
+constexpr char sceneMagic[4] = { 'S', 'H', 'P', 'B' };
+constexpr std::uint32_t sceneVersion = 1;
+constexpr std::size_t sceneRecordSize = 1 + 4 * sizeof(double) + sizeof(std::uint16_t);
+
+class SceneParseError : public std::runtime_error {
+public:
+    SceneParseError(const std::string& message, std::size_t offset)
+        : std::runtime_error(message), offset(offset) {}
+
+    std::size_t offset;
+};
+
+// Parses the text records in data[first, last); both ends are at line starts.
+class SceneTextParser {
+public:
+    SceneTextParser(std::string_view data, std::size_t first, std::size_t last)
+        : data(data), position(first), end(last) {}
+
+    void parse(std::vector<ShapeRecord>& records) {
+        while (position < end) {
+            skipSpaces();
+            if (position >= end || data[position] == '\n' || data[position] == '#') {
+                skipLine();
+                continue;
+            }
+
+            ShapeRecord record;
+            std::size_t lineStart = position;
+            std::string_view kind = token();
+            if (kind == "circle") {
+                record.kind = ShapeKind::Circle;
+            }
+            else if (kind == "rectangle") {
+                record.kind = ShapeKind::Rectangle;
+            }
+            else if (kind == "triangle") {
+                record.kind = ShapeKind::Triangle;
+            }
+            else {
+                throw SceneParseError("Unknown shape kind", lineStart);
+            }
+
+            record.x = number(lineStart);
+            record.y = number(lineStart);
+            record.a = number(lineStart);
+            record.b = record.kind == ShapeKind::Circle ? record.a : number(lineStart);
+            std::string_view color = token();
+            if (color.empty()) {
+                throw SceneParseError("Missing color", lineStart);
+            }
+            record.color = intern(color);
+            records.push_back(record);
+            skipLine();
+        }
+    }
+
+private:
+    void skipSpaces() {
+        while (position < end && (data[position] == ' ' || data[position] == '\t' || data[position] == '\r')) {
+            ++position;
+        }
+    }
+
+    void skipLine() {
+        while (position < end && data[position] != '\n') {
+            ++position;
+        }
+        ++position;
+    }
+
+    std::string_view token() {
+        skipSpaces();
+        std::size_t first = position;
+        while (position < end && !std::isspace(static_cast<unsigned char>(data[position]))) {
+            ++position;
+        }
+        return data.substr(first, position - first);
+    }
+
+    double number(std::size_t lineStart) {
+        skipSpaces();
+        double value = 0.0;
+        auto result = std::from_chars(data.data() + position, data.data() + end, value);
+        if (result.ec != std::errc()) {
+            throw SceneParseError("Invalid number", lineStart);
+        }
+        position = static_cast<std::size_t>(result.ptr - data.data());
+        return value;
+    }
+
+    // Per-parser cache in front of the shared palette.
+    ColorId intern(std::string_view color) {
+        auto it = colors.find(color);
+        if (it != colors.end()) {
+            return it->second;
+        }
+        ColorId id = ColorPalette::instance().intern(color);
+        colors.emplace(color, id);
+        return id;
+    }
+
+    std::string_view data;
+    std::size_t position;
+    std::size_t end;
+    std::unordered_map<std::string_view, ColorId> colors;
 };
 
+std::vector<ShapeRecord> parseBinaryScene(std::string_view data) {
+    std::size_t position = sizeof(sceneMagic);
+    auto read = [&](void* out, std::size_t size) {
+        if (size > data.size() - position) {
+            throw SceneParseError("Truncated scene file", position);
+        }
+        std::memcpy(out, data.data() + position, size);
+        position += size;
+    };
+
+    std::uint32_t version, colorCount;
+    read(&version, sizeof(version));
+    if (version != sceneVersion) {
+        throw SceneParseError("Unsupported scene version", 0);
+    }
+    read(&colorCount, sizeof(colorCount));
+    std::vector<ColorId> colors;
+    for (std::uint32_t i = 0; i < colorCount; ++i) {
+        std::uint16_t length;
+        read(&length, sizeof(length));
+        if (length > data.size() - position) {
+            throw SceneParseError("Truncated scene file", position);
+        }
+        colors.push_back(ColorPalette::instance().intern(data.substr(position, length)));
+        position += length;
+    }
+
+    std::uint64_t count;
+    read(&count, sizeof(count));
+    if (count > (data.size() - position) / sceneRecordSize) {
+        throw SceneParseError("Truncated scene file", position);
+    }
+    std::vector<ShapeRecord> records(static_cast<std::size_t>(count));
+    for (auto& record : records) {
+        std::uint8_t kind;
+        std::uint16_t color;
+        read(&kind, sizeof(kind));
+        read(&record.x, sizeof(double));
+        read(&record.y, sizeof(double));
+        read(&record.a, sizeof(double));
+        read(&record.b, sizeof(double));
+        read(&color, sizeof(color));
+        if (kind > static_cast<std::uint8_t>(ShapeKind::Triangle) || color >= colors.size()) {
+            throw SceneParseError("Invalid shape record", position - sceneRecordSize);
+        }
+        record.kind = static_cast<ShapeKind>(kind);
+        record.color = colors[color];
+    }
+    return records;
+}
+
+// Runs body(chunk) for chunk in [0, chunks) on up to threads workers and rethrows
+// the first failure after all of them finished.
+template <typename Body>
+void runChunks(std::size_t chunks, unsigned threads, Body&& body) {
+    std::atomic<std::size_t> next{ 0 };
+    std::vector<std::exception_ptr> errors(chunks);
+    auto worker = [&] {
+        for (std::size_t chunk = next++; chunk < chunks; chunk = next++) {
+            try {
+                body(chunk);
+            }
+            catch (...) {
+                errors[chunk] = std::current_exception();
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads && t < chunks; ++t) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+std::vector<ShapeRecord> parseScene(std::string_view data, unsigned threads = 0) {
+    if (data.size() >= sizeof(sceneMagic) && std::memcmp(data.data(), sceneMagic, sizeof(sceneMagic)) == 0) {
+        return parseBinaryScene(data);
+    }
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    constexpr std::size_t minChunkSize = 1 << 20;
+    std::size_t chunks = std::clamp<std::size_t>(data.size() / minChunkSize, 1, threads * 4);
+    std::vector<std::size_t> bounds{ 0 };
+    for (std::size_t i = 1; i < chunks; ++i) {
+        std::size_t split = data.find('\n', std::max(bounds.back(), data.size() * i / chunks));
+        if (split == std::string_view::npos) {
+            break;
+        }
+        bounds.push_back(split + 1);
+    }
+    bounds.push_back(data.size());
+    chunks = bounds.size() - 1;
+
+    std::vector<std::vector<ShapeRecord>> parts(chunks);
+    try {
+        runChunks(chunks, threads, [&](std::size_t chunk) {
+            parts[chunk].reserve((bounds[chunk + 1] - bounds[chunk]) / 32);
+            SceneTextParser(data, bounds[chunk], bounds[chunk + 1]).parse(parts[chunk]);
+        });
+    }
+    catch (const SceneParseError& error) {
+        auto line = std::count(data.begin(), data.begin() + error.offset, '\n') + 1;
+        throw std::runtime_error(std::string(error.what()) + " on line " + std::to_string(line));
+    }
+
+    std::size_t total = 0;
+    for (const auto& part : parts) {
+        total += part.size();
+    }
+    std::vector<ShapeRecord> records;
+    records.reserve(total);
+    for (const auto& part : parts) {
+        records.insert(records.end(), part.begin(), part.end());
+    }
+    return records;
+}
+
+std::vector<std::unique_ptr<Shape>> createShapes(std::span<const ShapeRecord> records, unsigned threads = 0) {
+    constexpr std::size_t chunkSize = 1 << 16;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::vector<std::unique_ptr<Shape>> shapes(records.size());
+    runChunks((records.size() + chunkSize - 1) / chunkSize, threads, [&](std::size_t chunk) {
+        std::size_t last = std::min(records.size(), (chunk + 1) * chunkSize);
+        for (std::size_t i = chunk * chunkSize; i < last; ++i) {
+            shapes[i] = ShapeFactory::forKind(records[i].kind).createShape(records[i]);
+        }
+    });
+    return shapes;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    file.seekg(0, std::ios::end);
+    std::string data(static_cast<std::size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!file) {
+        throw std::runtime_error("Cannot read " + path);
+    }
+    return data;
+}
+
+std::vector<std::unique_ptr<Shape>> loadScene(const std::string& path, unsigned threads = 0) {
+    std::string data = readFile(path);
+    return createShapes(parseScene(data, threads), threads);
+}
+
+void saveScene(const std::string& path, const std::vector<std::unique_ptr<Shape>>& shapes, bool binary) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Cannot open " + path + " for writing");
+    }
+
+    std::string buffer;
+    auto append = [&](const void* bytes, std::size_t size) {
+        buffer.append(static_cast<const char*>(bytes), size);
+    };
+    auto flush = [&] {
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    };
+    static const char* kindNames[] = { "circle", "rectangle", "triangle" };
+
+    if (binary) {
+        const ColorPalette& palette = ColorPalette::instance();
+        auto colorCount = static_cast<std::uint32_t>(palette.size());
+        append(sceneMagic, sizeof(sceneMagic));
+        append(&sceneVersion, sizeof(sceneVersion));
+        append(&colorCount, sizeof(colorCount));
+        for (std::uint32_t id = 0; id < colorCount; ++id) {
+            std::string_view name = palette.name(static_cast<ColorId>(id));
+            auto length = static_cast<std::uint16_t>(std::min<std::size_t>(name.size(), 0xFFFF));
+            append(&length, sizeof(length));
+            append(name.data(), length);
+        }
+        std::uint64_t count = shapes.size();
+        append(&count, sizeof(count));
+    }
+
+    for (const auto& shape : shapes) {
+        ShapeRecord record = shape->record();
+        if (binary) {
+            auto kind = static_cast<std::uint8_t>(record.kind);
+            append(&kind, sizeof(kind));
+            append(&record.x, sizeof(double));
+            append(&record.y, sizeof(double));
+            append(&record.a, sizeof(double));
+            append(&record.b, sizeof(double));
+            append(&record.color, sizeof(record.color));
+        }
+        else {
+            char number[32];
+            buffer += kindNames[static_cast<int>(record.kind)];
+            const double values[] = { record.x, record.y, record.a, record.b };
+            const std::size_t valueCount = record.kind == ShapeKind::Circle ? 3 : 4;
+            for (std::size_t i = 0; i < valueCount; ++i) {
+                buffer += ' ';
+                buffer.append(number, std::to_chars(number, number + sizeof(number), values[i]).ptr);
+            }
+            buffer += ' ';
+            buffer += ColorPalette::instance().name(record.color);
+            buffer += '\n';
+        }
+        if (buffer.size() >= (1 << 20)) {
+            flush();
+        }
+    }
+    flush();
+    if (!file) {
+        throw std::runtime_error("Failed to write " + path);
+    }
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Random mix of circles, rectangles and triangles spread so that the average
+// density does not depend on the count.
+template <typename Visitor>
+void generateRandomShapes(std::size_t count, Visitor&& visitor) {
+    std::mt19937_64 random(42);
+    const double worldSize = std::sqrt(static_cast<double>(count)) * 10.0;
+    std::uniform_real_distribution<double> position(0.0, worldSize);
+    std::uniform_real_distribution<double> size(0.5, 5.0);
+    for (std::size_t i = 0; i < count; ++i) {
+        double x = position(random), y = position(random), a = size(random), b = size(random);
+        switch (i % 3) {
+        case 0: visitor(Circle(x, y, a, "red")); break;
+        case 1: visitor(Rectangle(x, y, a, b, "green")); break;
+        default: visitor(Triangle(x, y, a, b, "blue")); break;
+        }
+    }
+}
+
+void benchmarkSpatialIndex(std::size_t count) {
+    constexpr int queryCount = 1000;
+    std::vector<BoundingBox> boxes;
+    boxes.reserve(count);
+    generateRandomShapes(count, [&](const Shape& shape) { boxes.push_back(shape.boundingBox()); });
+    if (boxes.empty()) {
+        return;
+    }
+
+    ShapeGridIndex index;
+    auto start = std::chrono::steady_clock::now();
+    index.bulkLoad(boxes);
+    std::cout << "Bulk load of " << count << " shapes: " << secondsSince(start) << " s\n";
+
+    const double worldSize = std::sqrt(static_cast<double>(count)) * 10.0;
+    std::mt19937_64 random(7);
+    std::uniform_real_distribution<double> position(0.0, worldSize);
+
+    std::size_t found = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < queryCount; ++i) {
+        double x = position(random), y = position(random);
+        found += index.query({ x, y, x + 50.0, y + 50.0 }).size();
+    }
+    double indexed = secondsSince(start);
+    std::cout << queryCount << " window queries (50x50): " << indexed * 1e6 / queryCount << " us/query, "
+        << found << " hits\n";
+
+    constexpr int scanCount = 10;
+    start = std::chrono::steady_clock::now();
+    found = 0;
+    for (int i = 0; i < scanCount; ++i) {
+        double x = position(random), y = position(random);
+        BoundingBox window{ x, y, x + 50.0, y + 50.0 };
+        found += std::count_if(boxes.begin(), boxes.end(), [&](const BoundingBox& box) { return box.intersects(window); });
+    }
+    std::cout << "Linear scan for comparison: " << secondsSince(start) * 1e6 / scanCount << " us/query ("
+        << found << " hits)\n";
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < queryCount; ++i) {
+        found += index.nearest(position(random), position(random), 10).size();
+    }
+    std::cout << queryCount << " nearest-10 queries: " << secondsSince(start) * 1e6 / queryCount << " us/query\n";
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < queryCount; ++i) {
+        double x = position(random), y = position(random);
+        index.insert({ x, y, x + 1.0, y + 1.0 });
+    }
+    std::cout << queryCount << " incremental inserts: " << secondsSince(start) * 1e6 / queryCount << " us/insert\n";
+}
+
+void benchmarkAreaComputation(std::size_t count) {
+    std::vector<std::unique_ptr<Shape>> shapes;
+    ShapeStore store;
+    shapes.reserve(count);
+    generateRandomShapes(count, [&](const auto& shape) {
+        shapes.push_back(std::make_unique<std::decay_t<decltype(shape)>>(shape));
+        store.add(shape);
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    double virtualTotal = 0.0;
+    for (const auto& shape : shapes) {
+        virtualTotal += shape->area();
+    }
+    double virtualSeconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    double storeTotal = store.totalArea();
+    double storeSeconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    auto byColor = store.areaByColor();
+    double byColorSeconds = secondsSince(start);
+
+    std::cout << "Virtual area() over " << count << " shapes: " << virtualSeconds * 1e3 << " ms (total " << virtualTotal << ")\n"
+        << "Structure-of-arrays total: " << storeSeconds * 1e3 << " ms (total " << storeTotal << ")\n"
+        << "Structure-of-arrays per-color totals: " << byColorSeconds * 1e3 << " ms\n";
+    for (std::uint32_t id = 0; id < byColor.size(); ++id) {
+        if (byColor[id] != 0.0) {
+            std::cout << "  " << ColorPalette::instance().name(static_cast<ColorId>(id)) << ": " << byColor[id] << "\n";
+        }
+    }
+}
+
+// Memory the heap really sets aside for a block obtained from operator new, which
+// rounds every request up and, with glibc, keeps a size word in front of it.
+std::size_t heapBlockSize(const void* block, [[maybe_unused]] std::size_t requested) {
+#if defined(_WIN32)
+    return _msize(const_cast<void*>(block));
+#elif defined(__GLIBC__)
+    return malloc_usable_size(const_cast<void*>(block)) + sizeof(std::size_t);
+#else
+    return requested;
+#endif
+}
+
+void benchmarkShapeCollection(std::size_t count) {
+    constexpr int passes = 10;
+    std::vector<std::unique_ptr<Shape>> pointers;
+    ShapeCollection values;
+    std::size_t heapBytes = 0;
+    pointers.reserve(count);
+    values.reserve(count);
+    generateRandomShapes(count, [&](const auto& shape) {
+        pointers.push_back(std::make_unique<std::decay_t<decltype(shape)>>(shape));
+        values.add(shape);
+        heapBytes += heapBlockSize(pointers.back().get(), sizeof(shape));
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    double pointerTotal = 0.0;
+    BoundingBox pointerBounds{};
+    for (int pass = 0; pass < passes; ++pass) {
+        pointerBounds = { std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+            -std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity() };
+        for (const auto& shape : pointers) {
+            BoundingBox box = shape->boundingBox();
+            pointerTotal += shape->area();
+            pointerBounds.minX = std::min(pointerBounds.minX, box.minX);
+            pointerBounds.minY = std::min(pointerBounds.minY, box.minY);
+            pointerBounds.maxX = std::max(pointerBounds.maxX, box.maxX);
+            pointerBounds.maxY = std::max(pointerBounds.maxY, box.maxY);
+        }
+    }
+    double pointerSeconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    double valueTotal = 0.0;
+    BoundingBox valueBounds{};
+    for (int pass = 0; pass < passes; ++pass) {
+        valueBounds = { std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+            -std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity() };
+        values.forEach([&](const auto& shape) {
+            BoundingBox box = shape.boundingBox();
+            valueTotal += shape.area();
+            valueBounds.minX = std::min(valueBounds.minX, box.minX);
+            valueBounds.minY = std::min(valueBounds.minY, box.minY);
+            valueBounds.maxX = std::max(valueBounds.maxX, box.maxX);
+            valueBounds.maxY = std::max(valueBounds.maxY, box.maxY);
+        });
+    }
+    double valueSeconds = secondsSince(start);
+
+    std::size_t pointerBytes = pointers.capacity() * sizeof(std::unique_ptr<Shape>) + heapBytes;
+    std::cout << "unique_ptr<Shape>: " << pointerSeconds * 1e3 / passes << " ms per pass, "
+        << pointerBytes / 1024 << " KiB in " << count + 1 << " heap blocks (total " << pointerTotal / passes
+        << ", extent " << pointerBounds.maxX - pointerBounds.minX << " x " << pointerBounds.maxY - pointerBounds.minY << ")\n"
+        << "variant collection: " << valueSeconds * 1e3 / passes << " ms per pass, "
+        << values.memoryUsage() / 1024 << " KiB in one heap block (total " << valueTotal / passes
+        << ", extent " << valueBounds.maxX - valueBounds.minX << " x " << valueBounds.maxY - valueBounds.minY << ")\n";
+}
+
+void benchmarkOverlapDetection(std::size_t count) {
+    std::vector<ShapeRecord> records;
+    records.reserve(count);
+    generateRandomShapes(count, [&](const Shape& shape) { records.push_back(shape.record()); });
+
+    auto start = std::chrono::steady_clock::now();
+    auto pairs = findOverlaps(records, 1);
+    double single = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    pairs = findOverlaps(records);
+    double parallel = secondsSince(start);
+
+    std::cout << "Overlap detection over " << count << " shapes: " << pairs.size() << " pairs, "
+        << single * 1e3 << " ms on one thread, " << parallel * 1e3 << " ms on "
+        << std::max(1u, std::thread::hardware_concurrency()) << " thread(s)\n";
+}
+
 int main() {
     std::unique_ptr<ShapeFactory> factory;
     std::vector<std::unique_ptr<Shape>> shapes;
+    ShapeGridIndex index;
 
     int choice;
     do {
@@ -160,6 +1681,16 @@ int main() {
             << "2. Create Rectangle\n"
             << "3. Create Triangle\n"
             << "4. Display All Shapes\n"
+            << "5. Find Shapes in Region\n"
+            << "6. Find Nearest Shapes\n"
+            << "7. Benchmark Spatial Index\n"
+            << "8. Benchmark Area Computation\n"
+            << "9. Statistics by Color\n"
+            << "10. Load Scene from File\n"
+            << "11. Save Scene to File\n"
+            << "12. Find Overlapping Shapes\n"
+            << "13. Benchmark Overlap Detection\n"
+            << "14. Benchmark Variant Collection\n"
             << "0. Exit\n"
             << "Choice: ";
         std::cin >> choice;
@@ -184,11 +1715,121 @@ int main() {
                         << "Color: " << shape->color() << "\n"
                         << "Bounding Circle Center: ("
                         << shape->boundingCircleCenter().first << ", "
-                        << shape->boundingCircleCenter().second << ")\n\n";
+                        << shape->boundingCircleCenter().second << ")\n"
+                        << "Bounding Circle Radius: " << shape->boundingCircle().radius << "\n\n";
+                }
+            }
+            continue;
+        }
+        else if (choice == 5) {
+            BoundingBox window;
+            std::cout << "Enter region (minX minY maxX maxY): ";
+            std::cin >> window.minX >> window.minY >> window.maxX >> window.maxY;
+            for (std::uint32_t id : index.query(window)) {
+                shapes[id]->display();
+            }
+            continue;
+        }
+        else if (choice == 6) {
+            double x, y;
+            std::size_t k;
+            std::cout << "Enter point (x, y): ";
+            std::cin >> x >> y;
+            std::cout << "Enter number of shapes: ";
+            std::cin >> k;
+            for (std::uint32_t id : index.nearest(x, y, k)) {
+                shapes[id]->display();
+            }
+            continue;
+        }
+        else if (choice == 7) {
+            std::size_t count;
+            std::cout << "Enter number of shapes: ";
+            std::cin >> count;
+            benchmarkSpatialIndex(count);
+            continue;
+        }
+        else if (choice == 8) {
+            std::size_t count;
+            std::cout << "Enter number of shapes: ";
+            std::cin >> count;
+            benchmarkAreaComputation(count);
+            continue;
+        }
+        else if (choice == 9) {
+            auto stats = aggregateByColor(shapes);
+            for (std::size_t id = 0; id < stats.size(); ++id) {
+                const ColorStats& entry = stats[id];
+                if (entry.count == 0) {
+                    continue;
                 }
+                std::cout << ColorPalette::instance().name(static_cast<ColorId>(id)) << ": " << entry.count
+                    << " shape(s), total area " << entry.totalArea << ", extent (" << entry.extent.minX << ", "
+                    << entry.extent.minY << ") - (" << entry.extent.maxX << ", " << entry.extent.maxY << ")\n";
             }
             continue;
         }
+        else if (choice == 10) {
+            std::string path;
+            std::cout << "Enter scene file: ";
+            std::cin >> path;
+            try {
+                auto start = std::chrono::steady_clock::now();
+                auto loaded = loadScene(path);
+                double seconds = secondsSince(start);
+                std::cout << "Loaded " << loaded.size() << " shapes in " << seconds << " s ("
+                    << (seconds > 0 ? loaded.size() / seconds : 0.0) << " shapes/s)\n";
+                shapes.reserve(shapes.size() + loaded.size());
+                std::move(loaded.begin(), loaded.end(), std::back_inserter(shapes));
+                index.bulkLoad(shapes);
+            }
+            catch (const std::exception& ex) {
+                std::cerr << "Error: " << ex.what() << "\n";
+            }
+            continue;
+        }
+        else if (choice == 11) {
+            std::string path;
+            int format;
+            std::cout << "Enter scene file: ";
+            std::cin >> path;
+            std::cout << "Format (1 - text, 2 - binary): ";
+            std::cin >> format;
+            try {
+                saveScene(path, shapes, format == 2);
+            }
+            catch (const std::exception& ex) {
+                std::cerr << "Error: " << ex.what() << "\n";
+            }
+            continue;
+        }
+        else if (choice == 12) {
+            std::vector<ShapeRecord> records;
+            records.reserve(shapes.size());
+            for (const auto& shape : shapes) {
+                records.push_back(shape->record());
+            }
+            auto pairs = findOverlaps(records);
+            std::cout << "Found " << pairs.size() << " overlapping pair(s).\n";
+            for (std::size_t i = 0; i < pairs.size() && i < 20; ++i) {
+                std::cout << "Shapes " << (pairs[i].first + 1) << " and " << (pairs[i].second + 1) << "\n";
+            }
+            continue;
+        }
+        else if (choice == 13) {
+            std::size_t count;
+            std::cout << "Enter number of shapes: ";
+            std::cin >> count;
+            benchmarkOverlapDetection(count);
+            continue;
+        }
+        else if (choice == 14) {
+            std::size_t count;
+            std::cout << "Enter number of shapes: ";
+            std::cin >> count;
+            benchmarkShapeCollection(count);
+            continue;
+        }
         else if (choice == 0) {
             break;
         }
@@ -199,6 +1840,7 @@ int main() {
 
         if (factory) {
             shapes.push_back(factory->createShape());
+            index.insert(*shapes.back());
         }
     } while (choice != 0);
 
@@ -1,13 +1,64 @@
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 #include <iostream>
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include <deque>
+#include <array>
+#include <optional>
+#include <map>
+#include <string_view>
+#include <limits>
+#include <fstream>
+#include <sstream>
+#include <utility>
+#include <random>
+#include <filesystem>
+#include <condition_variable>
+#include <functional>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <iterator>
+
+enum class BoardClass : std::uint8_t { Kids, Regular, Wide };
+constexpr std::size_t boardClassCount = 3;
+
+BoardClass boardClassFor(int shoeSize) {
+    if (shoeSize < 36) {
+        return BoardClass::Kids;
+    }
+    return shoeSize <= 44 ? BoardClass::Regular : BoardClass::Wide;
+}
+
+struct RentalQuote {
+    double snowboardPrice;
+    double setupPrice;
+};
 
 class RentalImplementation {
 public:
     virtual ~RentalImplementation() = default;
     virtual double getSnowboardPrice() const = 0;
     virtual double getSetupPrice() const = 0;
+
+    // Days are numbered from the start of the season, day 0 being a Monday.
+    virtual RentalQuote quote(BoardClass, int) const {
+        return { getSnowboardPrice(), getSetupPrice() };
+    }
 };
 
 class StandardRental : public RentalImplementation {
@@ -32,41 +83,773 @@ public:
     }
 };
 
+// Prices per tier from a rule file. Each line is
+//     <tier> <kids|regular|wide|*> <first-last|day|*> <weekdays|*> <min-demand> <snowboard> <setup>
+// where weekdays is a seven character Monday-first mask such as "MTWTF.." and
+// min-demand is the forecast utilisation (0..1) from which the rule applies. The
+// first matching rule of a tier wins. Rules are compiled into one flat table with a
+// contiguous range per (tier, board class), and quotes are memoized per
+// (tier, board class, day) until that day's demand changes.
+class PricingEngine {
+public:
+    static std::shared_ptr<PricingEngine> load(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) {
+            throw std::runtime_error("Cannot open pricing rules " + path + ".");
+        }
+        return parse(file);
+    }
+
+    static std::shared_ptr<PricingEngine> parse(std::istream& input) {
+        std::vector<std::pair<std::size_t, Rule>> parsed;
+        std::vector<std::string> tiers;
+        std::unordered_map<std::string, std::size_t> tierIds;
+        std::string line;
+        for (int lineNumber = 1; std::getline(input, line); ++lineNumber) {
+            std::istringstream fields(line.substr(0, line.find('#')));
+            std::string tier, boardClass, days, weekdays;
+            double minDemand, snowboardPrice, setupPrice;
+            if (!(fields >> tier)) {
+                continue;
+            }
+            std::string rest;
+            if (!(fields >> boardClass >> days >> weekdays >> minDemand >> snowboardPrice >> setupPrice) || (fields >> rest)) {
+                throw std::runtime_error("Pricing rule on line " + std::to_string(lineNumber) + " must have 7 fields.");
+            }
+            if (snowboardPrice < 0 || setupPrice < 0) {
+                throw std::runtime_error("Pricing rule on line " + std::to_string(lineNumber) + " has a negative price.");
+            }
+            auto [it, added] = tierIds.emplace(tier, tiers.size());
+            if (added) {
+                tiers.push_back(tier);
+            }
+            Rule rule{ 0, std::numeric_limits<int>::max(), 0x7F, minDemand, snowboardPrice, setupPrice, 0 };
+            rule.classMask = parseBoardClasses(boardClass, lineNumber);
+            parseDays(days, rule, lineNumber);
+            rule.weekdayMask = parseWeekdays(weekdays, lineNumber);
+            parsed.emplace_back(it->second, rule);
+        }
+        if (tiers.empty()) {
+            throw std::runtime_error("Pricing rules define no tiers.");
+        }
+
+        auto engine = std::shared_ptr<PricingEngine>(new PricingEngine());
+        engine->tierNames = std::move(tiers);
+        engine->tierIds = std::move(tierIds);
+        engine->ranges.resize(engine->tierNames.size() * boardClassCount);
+        for (std::size_t tier = 0; tier < engine->tierNames.size(); ++tier) {
+            for (std::size_t boardClass = 0; boardClass < boardClassCount; ++boardClass) {
+                Range& range = engine->ranges[tier * boardClassCount + boardClass];
+                range.first = static_cast<std::uint32_t>(engine->rules.size());
+                for (const auto& [ruleTier, rule] : parsed) {
+                    if (ruleTier == tier && (rule.classMask & (1u << boardClass))) {
+                        engine->rules.push_back(rule);
+                    }
+                }
+                range.last = static_cast<std::uint32_t>(engine->rules.size());
+            }
+        }
+        return engine;
+    }
+
+    std::size_t tierIndex(const std::string& tier) const {
+        auto it = tierIds.find(tier);
+        if (it == tierIds.end()) {
+            throw std::invalid_argument("Unknown pricing tier " + tier + ".");
+        }
+        return it->second;
+    }
+
+    const std::vector<std::string>& tiers() const {
+        return tierNames;
+    }
+
+    void setDemand(int day, double level) {
+        checkDay(day);
+        std::unique_lock lock(mutex);
+        demand[day] = level;
+        for (std::size_t tier = 0; tier < tierNames.size(); ++tier) {
+            for (std::size_t boardClass = 0; boardClass < boardClassCount; ++boardClass) {
+                quotes.erase(quoteKey(tier, static_cast<BoardClass>(boardClass), day));
+            }
+        }
+    }
+
+    RentalQuote quote(std::size_t tier, BoardClass boardClass, int day) const {
+        checkDay(day);
+        std::uint64_t key = quoteKey(tier, boardClass, day);
+        {
+            std::shared_lock lock(mutex);
+            auto it = quotes.find(key);
+            if (it != quotes.end()) {
+                return it->second;
+            }
+        }
+        std::unique_lock lock(mutex);
+        auto level = demand.find(day);
+        RentalQuote result = evaluate(tier, boardClass, day, level == demand.end() ? 0.0 : level->second);
+        quotes.emplace(key, result);
+        ++evaluations;
+        return result;
+    }
+
+    std::size_t ruleEvaluations() const {
+        std::shared_lock lock(mutex);
+        return evaluations;
+    }
+
+private:
+    struct Rule {
+        int firstDay;
+        int lastDay;
+        std::uint8_t weekdayMask;
+        double minDemand;
+        double snowboardPrice;
+        double setupPrice;
+        std::uint8_t classMask;
+    };
+
+    struct Range {
+        std::uint32_t first;
+        std::uint32_t last;
+    };
+
+    PricingEngine() = default;
+
+    static std::uint8_t parseBoardClasses(const std::string& text, int lineNumber) {
+        if (text == "*") {
+            return (1u << boardClassCount) - 1;
+        }
+        const char* names[] = { "kids", "regular", "wide" };
+        for (std::size_t i = 0; i < boardClassCount; ++i) {
+            if (text == names[i]) {
+                return static_cast<std::uint8_t>(1u << i);
+            }
+        }
+        throw std::runtime_error("Unknown board class " + text + " on line " + std::to_string(lineNumber) + ".");
+    }
+
+    static void parseDays(const std::string& text, Rule& rule, int lineNumber) {
+        if (text == "*") {
+            return;
+        }
+        try {
+            auto parseDay = [&](const std::string& part) {
+                std::size_t used = 0;
+                int day = std::stoi(part, &used);
+                if (used != part.size()) {
+                    throw std::invalid_argument(text);
+                }
+                return day;
+            };
+            std::size_t dash = text.find('-');
+            rule.firstDay = parseDay(text.substr(0, dash));
+            rule.lastDay = dash == std::string::npos ? rule.firstDay : parseDay(text.substr(dash + 1));
+            if (rule.firstDay < 0 || rule.lastDay < rule.firstDay) {
+                throw std::invalid_argument(text);
+            }
+        }
+        catch (const std::exception&) {
+            throw std::runtime_error("Invalid day range " + text + " on line " + std::to_string(lineNumber) + ".");
+        }
+    }
+
+    static std::uint8_t parseWeekdays(const std::string& text, int lineNumber) {
+        if (text == "*") {
+            return 0x7F;
+        }
+        if (text.size() != 7) {
+            throw std::runtime_error("Weekday mask " + text + " on line " + std::to_string(lineNumber) + " must have 7 characters.");
+        }
+        std::uint8_t mask = 0;
+        for (std::size_t i = 0; i < 7; ++i) {
+            if (text[i] != '.') {
+                mask |= static_cast<std::uint8_t>(1u << i);
+            }
+        }
+        return mask;
+    }
+
+    // Weekday masks are indexed by day % 7, which needs a day counted from 0.
+    static void checkDay(int day) {
+        if (day < 0) {
+            throw std::invalid_argument("Rental day cannot be negative.");
+        }
+    }
+
+    static std::uint64_t quoteKey(std::size_t tier, BoardClass boardClass, int day) {
+        return (static_cast<std::uint64_t>(tier) << 40) | (static_cast<std::uint64_t>(boardClass) << 32)
+            | static_cast<std::uint32_t>(day);
+    }
+
+    RentalQuote evaluate(std::size_t tier, BoardClass boardClass, int day, double level) const {
+        if (tier >= tierNames.size()) {
+            throw std::invalid_argument("Unknown pricing tier.");
+        }
+        const Range& range = ranges[tier * boardClassCount + static_cast<std::size_t>(boardClass)];
+        std::uint8_t weekday = static_cast<std::uint8_t>(1u << (day % 7));
+        for (std::uint32_t i = range.first; i < range.last; ++i) {
+            const Rule& rule = rules[i];
+            if (day >= rule.firstDay && day <= rule.lastDay && (rule.weekdayMask & weekday) && level >= rule.minDemand) {
+                return { rule.snowboardPrice, rule.setupPrice };
+            }
+        }
+        throw std::runtime_error("No pricing rule of tier " + tierNames[tier] + " matches day " + std::to_string(day) + ".");
+    }
+
+    std::vector<std::string> tierNames;
+    std::unordered_map<std::string, std::size_t> tierIds;
+    std::vector<Rule> rules;
+    std::vector<Range> ranges;
+
+    mutable std::shared_mutex mutex;
+    std::unordered_map<int, double> demand;
+    mutable std::unordered_map<std::uint64_t, RentalQuote> quotes;
+    mutable std::size_t evaluations = 0;
+};
+
+class DynamicRental : public RentalImplementation {
+public:
+    DynamicRental(std::shared_ptr<const PricingEngine> engine, const std::string& tier)
+        : engine(std::move(engine)), tier(this->engine->tierIndex(tier)) {}
+
+    double getSnowboardPrice() const override {
+        return quote(BoardClass::Regular, 0).snowboardPrice;
+    }
+
+    double getSetupPrice() const override {
+        return quote(BoardClass::Regular, 0).setupPrice;
+    }
+
+    RentalQuote quote(BoardClass boardClass, int day) const override {
+        return engine->quote(tier, boardClass, day);
+    }
+
+private:
+    std::shared_ptr<const PricingEngine> engine;
+    std::size_t tier;
+};
+
+enum class Direction : std::uint8_t { Left, Right };
+
+Direction parseDirection(const std::string& text) {
+    if (text == "left") {
+        return Direction::Left;
+    }
+    if (text == "right") {
+        return Direction::Right;
+    }
+    throw std::invalid_argument("Binding direction must be left or right.");
+}
+
+const char* directionName(Direction direction) {
+    return direction == Direction::Left ? "left" : "right";
+}
+
+// Brand names are interned once; everything else refers to them by a small id.
+class BrandCatalog {
+public:
+    using BrandId = std::uint16_t;
+
+    static BrandCatalog& instance() {
+        static BrandCatalog catalog;
+        return catalog;
+    }
+
+    BrandId intern(std::string_view brand) {
+        if (auto id = find(brand)) {
+            return *id;
+        }
+        std::unique_lock lock(mutex);
+        auto it = ids.find(brand);
+        if (it != ids.end()) {
+            return it->second;
+        }
+        if (names.size() > std::numeric_limits<BrandId>::max()) {
+            throw std::runtime_error("Too many snowboard brands.");
+        }
+        BrandId id = static_cast<BrandId>(names.size());
+        names.emplace_back(brand);
+        ids.emplace(names.back(), id);
+        return id;
+    }
+
+    std::optional<BrandId> find(std::string_view brand) const {
+        std::shared_lock lock(mutex);
+        auto it = ids.find(brand);
+        if (it == ids.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    const std::string& name(BrandId id) const {
+        std::shared_lock lock(mutex);
+        return names.at(id);
+    }
+
+    std::size_t size() const {
+        std::shared_lock lock(mutex);
+        return names.size();
+    }
+
+private:
+    BrandCatalog() = default;
+
+    mutable std::shared_mutex mutex;
+    // Keys view the strings in names, which a deque never moves.
+    std::deque<std::string> names;
+    std::unordered_map<std::string_view, BrandId> ids;
+};
+
+// Physical boards bucketed by (brand, shoe size, direction). Each bucket is a stack
+// of free board ids, so reserving and releasing are O(1); free counts per
+// (size, direction) are kept alongside for instant availability queries.
+class SnowboardInventory {
+public:
+    using BoardId = std::uint32_t;
+    static constexpr int minShoeSize = 30;
+    static constexpr int maxShoeSize = 50;
+
+    void stock(const std::string& brand, int size, Direction direction, std::size_t count) {
+        checkShoeSize(size);
+        BrandCatalog::BrandId brandId = BrandCatalog::instance().intern(brand);
+        std::lock_guard lock(mutex);
+        if (boards.size() + count > std::numeric_limits<BoardId>::max()) {
+            throw std::runtime_error("Inventory is full.");
+        }
+        if (brandId >= brandCount) {
+            brandCount = brandId + 1;
+            freeBoards.resize(static_cast<std::size_t>(brandCount) * bucketsPerBrand);
+        }
+        auto& bucket = freeBoards[bucketIndex(brandId, size, direction)];
+        for (std::size_t i = 0; i < count; ++i) {
+            bucket.push_back(static_cast<BoardId>(boards.size()));
+            boards.push_back({ brandId, static_cast<std::uint8_t>(size), direction, false });
+        }
+        freeCounts[sizeIndex(size, direction)] += count;
+    }
+
+    BoardId reserve(BrandCatalog::BrandId brandId, int size, Direction direction) {
+        checkShoeSize(size);
+        std::lock_guard lock(mutex);
+        if (brandId >= brandCount || freeBoards[bucketIndex(brandId, size, direction)].empty()) {
+            throw std::runtime_error("No free " + BrandCatalog::instance().name(brandId) + " snowboard for shoe size "
+                + std::to_string(size) + " with " + directionName(direction) + " binding.");
+        }
+        auto& bucket = freeBoards[bucketIndex(brandId, size, direction)];
+        BoardId id = bucket.back();
+        bucket.pop_back();
+        boards[id].rented = true;
+        --freeCounts[sizeIndex(size, direction)];
+        return id;
+    }
+
+    void release(BoardId id) {
+        std::lock_guard lock(mutex);
+        if (id >= boards.size() || !boards[id].rented) {
+            throw std::invalid_argument("Snowboard " + std::to_string(id) + " is not rented.");
+        }
+        Board& board = boards[id];
+        board.rented = false;
+        freeBoards[bucketIndex(board.brand, board.shoeSize, board.direction)].push_back(id);
+        ++freeCounts[sizeIndex(board.shoeSize, board.direction)];
+    }
+
+    std::size_t available(int size, Direction direction) const {
+        checkShoeSize(size);
+        std::lock_guard lock(mutex);
+        return freeCounts[sizeIndex(size, direction)];
+    }
+
+    std::size_t available(const std::string& brand, int size, Direction direction) const {
+        checkShoeSize(size);
+        auto brandId = BrandCatalog::instance().find(brand);
+        std::lock_guard lock(mutex);
+        if (!brandId || *brandId >= brandCount) {
+            return 0;
+        }
+        return freeBoards[bucketIndex(*brandId, size, direction)].size();
+    }
+
+    std::size_t size() const {
+        std::lock_guard lock(mutex);
+        return boards.size();
+    }
+
+private:
+    static constexpr std::size_t bucketsPerBrand = (maxShoeSize - minShoeSize + 1) * 2;
+
+    struct Board {
+        BrandCatalog::BrandId brand;
+        std::uint8_t shoeSize;
+        Direction direction;
+        bool rented;
+    };
+
+    static void checkShoeSize(int size) {
+        if (size < minShoeSize || size > maxShoeSize) {
+            throw std::invalid_argument("Shoe size must be between " + std::to_string(minShoeSize) + " and "
+                + std::to_string(maxShoeSize) + ".");
+        }
+    }
+
+    static std::size_t sizeIndex(int size, Direction direction) {
+        return static_cast<std::size_t>(size - minShoeSize) * 2 + static_cast<std::size_t>(direction);
+    }
+
+    static std::size_t bucketIndex(BrandCatalog::BrandId brand, int size, Direction direction) {
+        return brand * bucketsPerBrand + sizeIndex(size, direction);
+    }
+
+    mutable std::mutex mutex;
+    std::vector<Board> boards;
+    std::vector<std::vector<BoardId>> freeBoards;
+    std::array<std::size_t, bucketsPerBrand> freeCounts{};
+    BrandCatalog::BrandId brandCount = 0;
+};
+
+struct RentalFilter {
+    int firstDay = 0;
+    int lastDay = std::numeric_limits<int>::max();
+    std::optional<BrandCatalog::BrandId> brand;
+    std::optional<int> shoeSize;
+    std::optional<Direction> direction;
+};
+
+// Season history of rented line items, one column per field: day and brand take two
+// bytes, shoe size one and direction one bit, so tens of millions of rentals fit in
+// a few hundred megabytes. Aggregations are straight scans over the columns.
+class RentalLog {
+public:
+    void append(int day, BrandCatalog::BrandId brand, int shoeSize, Direction direction) {
+        checkDay(day);
+        checkShoeSize(shoeSize);
+        std::unique_lock lock(mutex);
+        std::size_t index = days.size();
+        if (index % 64 == 0) {
+            directionBits.push_back(0);
+        }
+        try {
+            days.push_back(static_cast<std::uint16_t>(day));
+            brands.push_back(brand);
+            shoeSizes.push_back(static_cast<std::uint8_t>(shoeSize));
+        }
+        catch (...) {
+            days.resize(index);
+            brands.resize(index);
+            shoeSizes.resize(index);
+            directionBits.resize((index + 63) / 64);
+            throw;
+        }
+        if (direction == Direction::Right) {
+            directionBits[index / 64] |= std::uint64_t{ 1 } << (index % 64);
+        }
+    }
+
+    void reserve(std::size_t count) {
+        std::unique_lock lock(mutex);
+        days.reserve(count);
+        brands.reserve(count);
+        shoeSizes.reserve(count);
+        directionBits.reserve((count + 63) / 64);
+    }
+
+    std::size_t size() const {
+        std::shared_lock lock(mutex);
+        return days.size();
+    }
+
+    std::size_t memoryUsage() const {
+        std::shared_lock lock(mutex);
+        return days.size() * (sizeof(std::uint16_t) + sizeof(BrandCatalog::BrandId) + sizeof(std::uint8_t))
+            + directionBits.size() * sizeof(std::uint64_t);
+    }
+
+    std::size_t count(const RentalFilter& filter) const {
+        std::shared_lock lock(mutex);
+        const unsigned firstDay = static_cast<unsigned>(std::max(filter.firstDay, 0));
+        const unsigned lastDay = static_cast<unsigned>(std::min<long long>(filter.lastDay, std::numeric_limits<std::uint16_t>::max()));
+        const bool anyBrand = !filter.brand;
+        const BrandCatalog::BrandId brand = filter.brand.value_or(0);
+        const bool anySize = !filter.shoeSize;
+        const int shoeSize = filter.shoeSize.value_or(0);
+        const bool anyDirection = !filter.direction;
+        const std::uint64_t right = filter.direction == Direction::Right;
+        std::size_t total = 0;
+        for (std::size_t block = 0; block * 64 < days.size(); ++block) {
+            const std::size_t first = block * 64;
+            const std::size_t last = std::min(days.size(), first + 64);
+            const std::uint64_t bits = directionBits[block];
+            for (std::size_t i = first; i < last; ++i) {
+                std::uint64_t isRight = (bits >> (i - first)) & 1;
+                total += (days[i] >= firstDay) & (days[i] <= lastDay) & (anyBrand | (brands[i] == brand))
+                    & (anySize | (shoeSizes[i] == shoeSize)) & (anyDirection | (isRight == right));
+            }
+        }
+        return total;
+    }
+
+    std::vector<std::size_t> countByBrand() const {
+        std::shared_lock lock(mutex);
+        return histogram(brands, BrandCatalog::instance().size());
+    }
+
+    std::vector<std::size_t> countByShoeSize() const {
+        std::shared_lock lock(mutex);
+        return histogram(shoeSizes, std::numeric_limits<std::uint8_t>::max() + 1);
+    }
+
+    std::vector<std::size_t> countByDay() const {
+        std::shared_lock lock(mutex);
+        std::size_t lastDay = days.empty() ? 0 : *std::max_element(days.begin(), days.end());
+        return histogram(days, days.empty() ? 0 : lastDay + 1);
+    }
+
+private:
+    static void checkDay(int day) {
+        if (day < 0 || day > std::numeric_limits<std::uint16_t>::max()) {
+            throw std::invalid_argument("Rental day must be between 0 and 65535.");
+        }
+    }
+
+    static void checkShoeSize(int size) {
+        if (size < 0 || size > std::numeric_limits<std::uint8_t>::max()) {
+            throw std::invalid_argument("Shoe size must be between 0 and 255.");
+        }
+    }
+
+    // Four interleaved partial histograms keep consecutive equal keys from
+    // serializing on the same counter.
+    template <typename Key>
+    static std::vector<std::size_t> histogram(const std::vector<Key>& column, std::size_t buckets) {
+        std::vector<std::size_t> partial(buckets * 4);
+        std::size_t i = 0;
+        for (; i + 4 <= column.size(); i += 4) {
+            ++partial[column[i]];
+            ++partial[buckets + column[i + 1]];
+            ++partial[2 * buckets + column[i + 2]];
+            ++partial[3 * buckets + column[i + 3]];
+        }
+        for (; i < column.size(); ++i) {
+            ++partial[column[i]];
+        }
+        std::vector<std::size_t> result(buckets);
+        for (std::size_t bucket = 0; bucket < buckets; ++bucket) {
+            result[bucket] = partial[bucket] + partial[buckets + bucket] + partial[2 * buckets + bucket] + partial[3 * buckets + bucket];
+        }
+        return result;
+    }
+
+    mutable std::shared_mutex mutex;
+    std::vector<std::uint16_t> days;
+    std::vector<BrandCatalog::BrandId> brands;
+    std::vector<std::uint8_t> shoeSizes;
+    std::vector<std::uint64_t> directionBits;
+};
+
 class SkiMuneris {
 protected:
-    std::shared_ptr<RentalImplementation> rentalImpl;
+    std::shared_ptr<const RentalImplementation> rentalImpl;
 
 public:
-    SkiMuneris(std::shared_ptr<RentalImplementation> impl) : rentalImpl(std::move(impl)) {}
+    SkiMuneris(std::shared_ptr<const RentalImplementation> impl) : rentalImpl(std::move(impl)) {}
     virtual ~SkiMuneris() = default;
     virtual void addSnowboard(const std::string& brand, int size, const std::string& direction) = 0;
     virtual double calculateTotalPrice() const = 0;
     virtual void displayOrder() const = 0;
-    void setRentalImplementation(std::shared_ptr<RentalImplementation> impl) {
-        rentalImpl = std::move(impl);
+    void setRentalImplementation(std::shared_ptr<const RentalImplementation> impl) {
+        auto previous = std::exchange(rentalImpl, std::move(impl));
+        try {
+            rentalImplementationChanged();
+        }
+        catch (...) {
+            rentalImpl = std::move(previous);
+            throw;
+        }
     }
+
+protected:
+    virtual void rentalImplementationChanged() {}
 };
 
 class SnowboardRental : public SkiMuneris {
     struct Snowboard {
-        std::string brand;
-        int shoeSize;
-        std::string direction;
+        BrandCatalog::BrandId brand;
+        std::uint8_t shoeSize;
+        Direction direction;
+        SnowboardInventory::BoardId boardId;
+        std::uint16_t rentedOn;
     };
 
+    SnowboardInventory* inventory;
+    RentalLog* log;
     std::vector<Snowboard> snowboards;
+    // Every snowboard is priced on the day it was rented. A tier prices all snowboards
+    // of a board class the same on a given day, so the total is the item count per
+    // (day, class) times a price cached per (day, class); the prices are re-quoted
+    // when the tier changes or on requote().
+    struct DayTotals {
+        std::array<std::size_t, boardClassCount> count{};
+        std::array<double, boardClassCount> pricePerSnowboard{};
+    };
+
+    int rentalDay = 0;
+    std::map<int, DayTotals> totalsByDay;
+
+    std::array<double, boardClassCount> quoteDay(int day) const {
+        std::array<double, boardClassCount> prices{};
+        for (std::size_t i = 0; i < boardClassCount; ++i) {
+            RentalQuote quote = rentalImpl->quote(static_cast<BoardClass>(i), day);
+            prices[i] = quote.snowboardPrice + quote.setupPrice;
+        }
+        return prices;
+    }
+
+    // Quotes everything before changing anything, so a failed quote leaves the old
+    // prices; the current day is checked too, as new snowboards are priced on it.
+    void refreshPrices() {
+        quoteDay(rentalDay);
+        std::vector<std::array<double, boardClassCount>> prices;
+        prices.reserve(totalsByDay.size());
+        for (const auto& entry : totalsByDay) {
+            prices.push_back(quoteDay(entry.first));
+        }
+        auto price = prices.begin();
+        for (auto& entry : totalsByDay) {
+            entry.second.pricePerSnowboard = *price++;
+        }
+    }
+
+protected:
+    void rentalImplementationChanged() override {
+        refreshPrices();
+    }
 
 public:
-    SnowboardRental(std::shared_ptr<RentalImplementation> impl) : SkiMuneris(std::move(impl)) {}
+    // Without an inventory any snowboard can be ordered; with one, every snowboard is
+    // a reserved board that goes back to stock when it is returned. Every added
+    // snowboard is also recorded in the log, if there is one.
+    SnowboardRental(std::shared_ptr<const RentalImplementation> impl, SnowboardInventory* inventory = nullptr,
+        RentalLog* log = nullptr)
+        : SkiMuneris(std::move(impl)), inventory(inventory), log(log) {
+        refreshPrices();
+    }
+
+    SnowboardRental(const SnowboardRental&) = delete;
+    SnowboardRental& operator=(const SnowboardRental&) = delete;
+
+    ~SnowboardRental() override {
+        returnSnowboards();
+    }
 
     void addSnowboard(const std::string& brand, int size, const std::string& direction) override {
-        snowboards.push_back({ brand, size, direction });
+        addSnowboardOn(rentalDay, BrandCatalog::instance().intern(brand), size, parseDirection(direction));
+    }
+
+    // For callers that resolve the brand and direction once up front.
+    void addSnowboard(BrandCatalog::BrandId brand, int size, Direction direction) {
+        addSnowboardOn(rentalDay, brand, size, direction);
+    }
+
+    // Re-adds a snowboard rented on an earlier day, e.g. when an order is restored;
+    // the rental log keeps the original day.
+    void restoreSnowboard(const std::string& brand, int size, Direction direction, int day) {
+        if (day < 0 || day > std::numeric_limits<std::uint16_t>::max()) {
+            throw std::invalid_argument("Rental day must be between 0 and 65535.");
+        }
+        addSnowboardOn(day, BrandCatalog::instance().intern(brand), size, direction);
+    }
+
+private:
+    void addSnowboardOn(int day, BrandCatalog::BrandId brandId, int size, Direction parsedDirection) {
+        if (size < 0 || size > std::numeric_limits<std::uint8_t>::max()) {
+            throw std::invalid_argument("Shoe size must be between 0 and 255.");
+        }
+        auto dayTotals = totalsByDay.find(day);
+        bool newDay = dayTotals == totalsByDay.end();
+        if (newDay) {
+            dayTotals = totalsByDay.emplace(day, DayTotals{ {}, quoteDay(day) }).first;
+        }
+        SnowboardInventory::BoardId boardId = 0;
+        try {
+            if (inventory) {
+                boardId = inventory->reserve(brandId, size, parsedDirection);
+            }
+        }
+        catch (...) {
+            if (newDay) {
+                totalsByDay.erase(dayTotals);
+            }
+            throw;
+        }
+        try {
+            snowboards.push_back({ brandId, static_cast<std::uint8_t>(size), parsedDirection, boardId,
+                static_cast<std::uint16_t>(day) });
+            if (log) {
+                try {
+                    log->append(day, brandId, size, parsedDirection);
+                }
+                catch (...) {
+                    snowboards.pop_back();
+                    throw;
+                }
+            }
+        }
+        catch (...) {
+            if (inventory) {
+                inventory->release(boardId);
+            }
+            if (newDay) {
+                totalsByDay.erase(dayTotals);
+            }
+            throw;
+        }
+        ++dayTotals->second.count[static_cast<std::size_t>(boardClassFor(size))];
+    }
+
+public:
+    void returnSnowboards() {
+        if (inventory) {
+            for (const auto& snowboard : snowboards) {
+                inventory->release(snowboard.boardId);
+            }
+        }
+        snowboards.clear();
+        totalsByDay.clear();
+    }
+
+    void setRentalDay(int day) {
+        if (day < 0 || day > std::numeric_limits<std::uint16_t>::max()) {
+            throw std::invalid_argument("Rental day must be between 0 and 65535.");
+        }
+        quoteDay(day);
+        rentalDay = day;
+    }
+
+    int getRentalDay() const {
+        return rentalDay;
+    }
+
+    template <typename Visitor>
+    void forEachSnowboard(Visitor&& visitor) const {
+        for (const auto& snowboard : snowboards) {
+            visitor(BrandCatalog::instance().name(snowboard.brand), static_cast<int>(snowboard.shoeSize), snowboard.direction,
+                static_cast<int>(snowboard.rentedOn));
+        }
+    }
+
+    // Picks up demand changes for the days in the order.
+    void requote() {
+        refreshPrices();
     }
 
     double calculateTotalPrice() const override {
         double total = 0.0;
-        for (const auto& snowboard : snowboards) {
-            total += rentalImpl->getSnowboardPrice() + rentalImpl->getSetupPrice();
+        for (const auto& entry : totalsByDay) {
+            for (std::size_t i = 0; i < boardClassCount; ++i) {
+                total += static_cast<double>(entry.second.count[i]) * entry.second.pricePerSnowboard[i];
+            }
         }
         return total;
     }
@@ -80,19 +863,830 @@ public:
         std::cout << "Snowboard Rental Order:\n";
         for (size_t i = 0; i < snowboards.size(); ++i) {
             const auto& sb = snowboards[i];
-            std::cout << i + 1 << ". Brand: " << sb.brand
-                << ", Shoe Size: " << sb.shoeSize
-                << ", Direction: " << sb.direction << "\n";
+            std::cout << i + 1 << ". Brand: " << BrandCatalog::instance().name(sb.brand)
+                << ", Shoe Size: " << static_cast<int>(sb.shoeSize)
+                << ", Direction: " << directionName(sb.direction) << "\n";
         }
         std::cout << "Total Price: $" << calculateTotalPrice() << "\n";
     }
 };
 
+enum class JournalRecordType : std::uint8_t { AddSnowboard = 1, SetTier = 2, SetRentalDay = 3, ReturnSnowboards = 4 };
+
+struct JournalRecord {
+    JournalRecordType type;
+    std::string text;
+    int shoeSize = 0;
+    Direction direction = Direction::Left;
+    int day = 0;
+};
+
+// Append-only journal of rental operations with group commit. append() only encodes
+// the record into a buffer; a background thread writes and syncs the buffer every
+// commit interval (or sooner when it grows large or someone waits), so a single
+// fsync covers every record appended since the last one. A snapshot replaces the
+// journal: it is written to the side, synced, renamed into place and followed by a
+// fresh journal of the next generation, so a crash at any point recovers either the
+// old snapshot and journal or the new ones. On open, the snapshot and the valid
+// prefix of the journal are read back and a torn tail is cut off.
+//
+// Files start with a four byte magic, a version and a generation number; records
+// are a payload size, an FNV-1a checksum of the payload and the payload itself, with
+// integers in native byte order.
+class RentalJournal {
+public:
+    using Sequence = std::uint64_t;
+
+    struct Statistics {
+        std::uint64_t records = 0;
+        std::uint64_t commits = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    explicit RentalJournal(std::string path, std::chrono::milliseconds commitInterval = std::chrono::milliseconds(10))
+        : journalPath(std::move(path)), snapshotPath(journalPath + ".snap"), commitInterval(commitInterval) {
+        recover();
+        file = std::fopen(journalPath.c_str(), "ab");
+        if (!file) {
+            throw std::runtime_error("Cannot open journal " + journalPath + ".");
+        }
+        committer = std::thread([this] { commitLoop(); });
+    }
+
+    RentalJournal(const RentalJournal&) = delete;
+    RentalJournal& operator=(const RentalJournal&) = delete;
+
+    ~RentalJournal() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        committer.join();
+        if (file) {
+            std::fclose(file);
+        }
+    }
+
+    // Snapshot records followed by the journal records that were on disk when the
+    // journal was opened.
+    const std::vector<JournalRecord>& recovered() const {
+        return recoveredRecords;
+    }
+
+    Sequence append(const JournalRecord& record) {
+        std::string payload = encode(record);
+        std::uint32_t size = static_cast<std::uint32_t>(payload.size());
+        std::uint32_t checksum = fnv1a(payload);
+        std::unique_lock lock(mutex);
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+        buffer.append(reinterpret_cast<const char*>(&size), sizeof(size));
+        buffer.append(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+        buffer += payload;
+        ++recordsSinceSnapshot;
+        Sequence sequence = ++appended;
+        if (buffer.size() >= eagerCommitBytes) {
+            wake.notify_one();
+        }
+        return sequence;
+    }
+
+    // Blocks until the record with the given sequence number is on stable storage.
+    void waitDurable(Sequence sequence) {
+        std::unique_lock lock(mutex);
+        if (durable < sequence) {
+            ++waiters;
+            wake.notify_one();
+            committed.wait(lock, [&] { return durable >= sequence || failure; });
+            --waiters;
+        }
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+
+    void commit() {
+        Sequence sequence;
+        {
+            std::lock_guard lock(mutex);
+            sequence = appended;
+        }
+        waitDurable(sequence);
+    }
+
+    void writeSnapshot(const std::vector<JournalRecord>& state) {
+        std::lock_guard fileLock(fileMutex);
+        flushLocked();
+        std::uint64_t nextGeneration = generation + 1;
+
+        std::string tempPath = snapshotPath + ".tmp";
+        std::FILE* snapshot = std::fopen(tempPath.c_str(), "wb");
+        if (!snapshot) {
+            throw std::runtime_error("Cannot create snapshot " + tempPath + ".");
+        }
+        std::string contents = header(snapshotMagic, nextGeneration);
+        for (const auto& record : state) {
+            appendRecord(contents, encode(record));
+        }
+        bool written = std::fwrite(contents.data(), 1, contents.size(), snapshot) == contents.size() && syncFile(snapshot);
+        std::fclose(snapshot);
+        if (!written) {
+            throw std::runtime_error("Cannot write snapshot " + tempPath + ".");
+        }
+        std::filesystem::rename(tempPath, snapshotPath);
+
+        std::string freshPath = journalPath + ".tmp";
+        std::FILE* fresh = std::fopen(freshPath.c_str(), "wb");
+        std::string freshHeader = header(journalMagic, nextGeneration);
+        if (!fresh || std::fwrite(freshHeader.data(), 1, freshHeader.size(), fresh) != freshHeader.size() || !syncFile(fresh)) {
+            if (fresh) {
+                std::fclose(fresh);
+            }
+            throw std::runtime_error("Cannot start journal " + freshPath + ".");
+        }
+        std::fclose(fresh);
+        // Windows cannot replace an open file. Past the snapshot rename, records that
+        // do not reach the new journal would be lost, so any failure here is final.
+        std::fclose(file);
+        std::error_code error;
+        std::filesystem::rename(freshPath, journalPath, error);
+        file = std::fopen(journalPath.c_str(), "ab");
+        std::lock_guard lock(mutex);
+        if (error || !file) {
+            failure = std::make_exception_ptr(std::runtime_error("Cannot switch to journal " + freshPath + "."));
+            std::rethrow_exception(failure);
+        }
+        generation = nextGeneration;
+        recordsSinceSnapshot = 0;
+    }
+
+    std::size_t pendingSnapshotRecords() const {
+        std::lock_guard lock(mutex);
+        return recordsSinceSnapshot;
+    }
+
+    Statistics statistics() const {
+        std::lock_guard lock(mutex);
+        return stats;
+    }
+
+private:
+    static constexpr char journalMagic[4] = { 'R', 'J', 'N', 'L' };
+    static constexpr char snapshotMagic[4] = { 'R', 'S', 'N', 'P' };
+    static constexpr std::uint32_t formatVersion = 2;
+    static constexpr std::size_t headerSize = 16;
+    static constexpr std::size_t eagerCommitBytes = 1 << 20;
+
+    static std::uint32_t fnv1a(std::string_view data) {
+        std::uint32_t hash = 2166136261u;
+        for (unsigned char c : data) {
+            hash = (hash ^ c) * 16777619u;
+        }
+        return hash;
+    }
+
+    static std::string header(const char (&magic)[4], std::uint64_t fileGeneration) {
+        std::string result(magic, 4);
+        result.append(reinterpret_cast<const char*>(&formatVersion), sizeof(formatVersion));
+        result.append(reinterpret_cast<const char*>(&fileGeneration), sizeof(fileGeneration));
+        return result;
+    }
+
+    static void appendRecord(std::string& out, const std::string& payload) {
+        std::uint32_t size = static_cast<std::uint32_t>(payload.size());
+        std::uint32_t checksum = fnv1a(payload);
+        out.append(reinterpret_cast<const char*>(&size), sizeof(size));
+        out.append(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+        out += payload;
+    }
+
+    static std::string encode(const JournalRecord& record) {
+        if (record.text.size() > std::numeric_limits<std::uint16_t>::max()) {
+            throw std::invalid_argument("Journal record text is too long.");
+        }
+        std::string payload(1, static_cast<char>(record.type));
+        std::uint16_t length = static_cast<std::uint16_t>(record.text.size());
+        switch (record.type) {
+        case JournalRecordType::AddSnowboard:
+        {
+            std::uint16_t day = static_cast<std::uint16_t>(record.day);
+            payload += static_cast<char>(static_cast<std::uint8_t>(record.shoeSize));
+            payload += static_cast<char>(record.direction);
+            payload.append(reinterpret_cast<const char*>(&day), sizeof(day));
+            payload.append(reinterpret_cast<const char*>(&length), sizeof(length));
+            payload += record.text;
+            break;
+        }
+        case JournalRecordType::SetTier:
+            payload.append(reinterpret_cast<const char*>(&length), sizeof(length));
+            payload += record.text;
+            break;
+        case JournalRecordType::SetRentalDay: {
+            std::uint16_t day = static_cast<std::uint16_t>(record.day);
+            payload.append(reinterpret_cast<const char*>(&day), sizeof(day));
+            break;
+        }
+        case JournalRecordType::ReturnSnowboards:
+            break;
+        }
+        return payload;
+    }
+
+    static std::optional<JournalRecord> decode(std::string_view payload) {
+        if (payload.empty()) {
+            return std::nullopt;
+        }
+        JournalRecord record{ static_cast<JournalRecordType>(payload[0]), {} };
+        payload.remove_prefix(1);
+        auto readText = [&]() -> bool {
+            std::uint16_t length;
+            if (payload.size() < sizeof(length)) {
+                return false;
+            }
+            std::memcpy(&length, payload.data(), sizeof(length));
+            payload.remove_prefix(sizeof(length));
+            if (payload.size() != length) {
+                return false;
+            }
+            record.text.assign(payload);
+            return true;
+        };
+        switch (record.type) {
+        case JournalRecordType::AddSnowboard:
+        {
+            std::uint16_t day;
+            if (payload.size() < 2 + sizeof(day) || static_cast<std::uint8_t>(payload[1]) > 1) {
+                return std::nullopt;
+            }
+            record.shoeSize = static_cast<std::uint8_t>(payload[0]);
+            record.direction = static_cast<Direction>(payload[1]);
+            std::memcpy(&day, payload.data() + 2, sizeof(day));
+            record.day = day;
+            payload.remove_prefix(2 + sizeof(day));
+            return readText() ? std::optional(record) : std::nullopt;
+        }
+        case JournalRecordType::SetTier:
+            return readText() ? std::optional(record) : std::nullopt;
+        case JournalRecordType::SetRentalDay: {
+            std::uint16_t day;
+            if (payload.size() != sizeof(day)) {
+                return std::nullopt;
+            }
+            std::memcpy(&day, payload.data(), sizeof(day));
+            record.day = day;
+            return record;
+        }
+        case JournalRecordType::ReturnSnowboards:
+            return payload.empty() ? std::optional(record) : std::nullopt;
+        }
+        return std::nullopt;
+    }
+
+    static bool syncFile(std::FILE* stream) {
+        if (std::fflush(stream) != 0) {
+            return false;
+        }
+#ifdef _WIN32
+        return _commit(_fileno(stream)) == 0;
+#else
+        return fsync(fileno(stream)) == 0;
+#endif
+    }
+
+    static std::string readAll(const std::string& path) {
+        std::ifstream input(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    }
+
+    // Returns the generation and the length of the valid prefix, appending the
+    // decoded records; nullopt if the header is missing or foreign.
+    static std::optional<std::pair<std::uint64_t, std::size_t>> readRecords(const std::string& data, const char (&magic)[4],
+        std::vector<JournalRecord>& records) {
+        std::uint32_t version;
+        std::uint64_t fileGeneration;
+        if (data.size() < headerSize || std::memcmp(data.data(), magic, 4) != 0) {
+            return std::nullopt;
+        }
+        std::memcpy(&version, data.data() + 4, sizeof(version));
+        std::memcpy(&fileGeneration, data.data() + 8, sizeof(fileGeneration));
+        if (version != formatVersion) {
+            throw std::runtime_error("Unsupported journal version " + std::to_string(version) + ".");
+        }
+        std::size_t offset = headerSize;
+        while (data.size() - offset >= 8) {
+            std::uint32_t size, checksum;
+            std::memcpy(&size, data.data() + offset, sizeof(size));
+            std::memcpy(&checksum, data.data() + offset + 4, sizeof(checksum));
+            if (data.size() - offset - 8 < size) {
+                break;
+            }
+            std::string_view payload(data.data() + offset + 8, size);
+            auto record = fnv1a(payload) == checksum ? decode(payload) : std::nullopt;
+            if (!record) {
+                break;
+            }
+            records.push_back(std::move(*record));
+            offset += 8 + size;
+        }
+        return std::make_pair(fileGeneration, offset);
+    }
+
+    void recover() {
+        std::uint64_t snapshotGeneration = 0;
+        if (std::filesystem::exists(snapshotPath)) {
+            std::string data = readAll(snapshotPath);
+            auto result = readRecords(data, snapshotMagic, recoveredRecords);
+            if (!result || result->second != data.size()) {
+                throw std::runtime_error("Snapshot " + snapshotPath + " is damaged.");
+            }
+            snapshotGeneration = result->first;
+        }
+        generation = snapshotGeneration;
+
+        std::vector<JournalRecord> journalRecords;
+        std::string data = std::filesystem::exists(journalPath) ? readAll(journalPath) : std::string();
+        auto result = readRecords(data, journalMagic, journalRecords);
+        if (result && result->first == snapshotGeneration) {
+            recoveredRecords.insert(recoveredRecords.end(), std::make_move_iterator(journalRecords.begin()),
+                std::make_move_iterator(journalRecords.end()));
+            recordsSinceSnapshot = journalRecords.size();
+            if (result->second != data.size()) {
+                std::filesystem::resize_file(journalPath, result->second);
+            }
+            return;
+        }
+        // No journal yet, a torn header, or a journal the snapshot already covers.
+        std::ofstream fresh(journalPath, std::ios::binary | std::ios::trunc);
+        std::string freshHeader = header(journalMagic, generation);
+        if (!fresh.write(freshHeader.data(), freshHeader.size()).flush()) {
+            throw std::runtime_error("Cannot create journal " + journalPath + ".");
+        }
+    }
+
+    // Writes out everything appended so far; fileMutex must be held.
+    void flushLocked() {
+        std::string pending;
+        Sequence last;
+        std::uint64_t records;
+        {
+            std::lock_guard lock(mutex);
+            pending.swap(buffer);
+            last = appended;
+            records = last - durable;
+        }
+        if (records == 0) {
+            return;
+        }
+        bool written = file && std::fwrite(pending.data(), 1, pending.size(), file) == pending.size() && syncFile(file);
+        std::lock_guard lock(mutex);
+        if (written) {
+            durable = last;
+            stats.records += records;
+            stats.bytes += pending.size();
+            ++stats.commits;
+        }
+        else if (!failure) {
+            failure = std::make_exception_ptr(std::runtime_error("Cannot write journal " + journalPath + "."));
+        }
+        committed.notify_all();
+    }
+
+    void commitLoop() {
+        std::unique_lock lock(mutex);
+        while (!stopping) {
+            wake.wait_for(lock, commitInterval, [&] { return stopping || waiters > 0 || buffer.size() >= eagerCommitBytes; });
+            lock.unlock();
+            {
+                std::lock_guard fileLock(fileMutex);
+                flushLocked();
+            }
+            lock.lock();
+        }
+        lock.unlock();
+        std::lock_guard fileLock(fileMutex);
+        flushLocked();
+    }
+
+    std::string journalPath;
+    std::string snapshotPath;
+    std::chrono::milliseconds commitInterval;
+    std::vector<JournalRecord> recoveredRecords;
+    std::uint64_t generation = 0;
+
+    std::mutex fileMutex;
+    std::FILE* file = nullptr;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable committed;
+    std::string buffer;
+    Sequence appended = 0;
+    Sequence durable = 0;
+    std::size_t waiters = 0;
+    std::size_t recordsSinceSnapshot = 0;
+    bool stopping = false;
+    std::exception_ptr failure;
+    Statistics stats;
+    std::thread committer;
+};
+
+// Applies operations to a rental and journals the ones that succeeded. Tiers are
+// journaled by name and turned back into implementations by the resolver.
+class JournaledRental {
+public:
+    using TierResolver = std::function<std::shared_ptr<const RentalImplementation>(const std::string&)>;
+
+    JournaledRental(SnowboardRental& rental, RentalJournal& journal, TierResolver resolveTier,
+        std::string initialTier, std::size_t snapshotInterval = 10000)
+        : rental(rental), journal(journal), resolveTier(std::move(resolveTier)), tier(std::move(initialTier)),
+        snapshotInterval(snapshotInterval) {}
+
+    struct ReplayResult {
+        std::size_t applied = 0;
+        std::size_t failed = 0;
+    };
+
+    ReplayResult replay() {
+        const auto& records = journal.recovered();
+        ReplayResult result;
+        for (const auto& entry : records) {
+            try {
+                apply(entry);
+                ++result.applied;
+            }
+            catch (const std::exception&) {
+                ++result.failed;
+            }
+        }
+        return result;
+    }
+
+    void addSnowboard(const std::string& brand, int size, const std::string& direction) {
+        record({ JournalRecordType::AddSnowboard, brand, size, parseDirection(direction), rental.getRentalDay() });
+    }
+
+    void setTier(const std::string& name) {
+        record({ JournalRecordType::SetTier, name });
+    }
+
+    void setRentalDay(int day) {
+        JournalRecord entry{ JournalRecordType::SetRentalDay, {} };
+        entry.day = day;
+        record(entry);
+    }
+
+    // Completing an order is a sync point: it only returns once everything journaled
+    // so far is on stable storage.
+    void returnSnowboards() {
+        record({ JournalRecordType::ReturnSnowboards, {} });
+        sync();
+    }
+
+    void sync() {
+        journal.commit();
+    }
+
+    void snapshot() {
+        std::vector<JournalRecord> state;
+        state.push_back({ JournalRecordType::SetTier, tier });
+        JournalRecord day{ JournalRecordType::SetRentalDay, {} };
+        day.day = rental.getRentalDay();
+        state.push_back(day);
+        rental.forEachSnowboard([&](const std::string& brand, int size, Direction direction, int rentedOn) {
+            state.push_back({ JournalRecordType::AddSnowboard, brand, size, direction, rentedOn });
+        });
+        journal.writeSnapshot(state);
+    }
+
+private:
+    void apply(const JournalRecord& entry) {
+        switch (entry.type) {
+        case JournalRecordType::AddSnowboard:
+            rental.restoreSnowboard(entry.text, entry.shoeSize, entry.direction, entry.day);
+            break;
+        case JournalRecordType::SetTier:
+            rental.setRentalImplementation(resolveTier(entry.text));
+            tier = entry.text;
+            break;
+        case JournalRecordType::SetRentalDay:
+            rental.setRentalDay(entry.day);
+            break;
+        case JournalRecordType::ReturnSnowboards:
+            rental.returnSnowboards();
+            break;
+        }
+    }
+
+    // Only operations that took effect are journaled. append() does not wait for the
+    // disk: the journal's committer covers many records with one fsync, and callers
+    // that must not lose an operation wait at a sync point.
+    void record(const JournalRecord& entry) {
+        apply(entry);
+        journal.append(entry);
+        if (journal.pendingSnapshotRecords() >= snapshotInterval) {
+            snapshot();
+        }
+    }
+
+    SnowboardRental& rental;
+    RentalJournal& journal;
+    TierResolver resolveTier;
+    std::string tier;
+    std::size_t snapshotInterval;
+};
+
+// Many concurrent orders keyed by ID. Orders are spread over shards by ID; a shard
+// lock is only held exclusively to open or close orders, and each order has its own
+// mutex, so counters working on different orders never wait on each other. Tiers
+// are immutable and shared by all orders.
+class RentalService {
+public:
+    using OrderId = std::uint64_t;
+
+    explicit RentalService(SnowboardInventory* inventory = nullptr, RentalLog* log = nullptr, std::size_t shardCount = 64)
+        : inventory(inventory), log(log), shardCount(std::max<std::size_t>(1, shardCount)), shards(new Shard[this->shardCount]) {}
+
+    OrderId openOrder(std::shared_ptr<const RentalImplementation> impl) {
+        OrderId id = nextOrderId.fetch_add(1, std::memory_order_relaxed);
+        auto order = std::make_shared<Order>(std::move(impl), inventory, log);
+        Shard& shard = shardFor(id);
+        std::unique_lock lock(shard.mutex);
+        shard.orders.emplace(id, std::move(order));
+        return id;
+    }
+
+    bool closeOrder(OrderId id) {
+        Shard& shard = shardFor(id);
+        std::unique_lock lock(shard.mutex);
+        return shard.orders.erase(id) != 0;
+    }
+
+    // Interning takes the catalog's process-wide lock; counters that add many
+    // snowboards resolve their brands once and use the BrandId overload.
+    void addSnowboard(OrderId id, const std::string& brand, int size, const std::string& direction) {
+        addSnowboard(id, BrandCatalog::instance().intern(brand), size, parseDirection(direction));
+    }
+
+    void addSnowboard(OrderId id, BrandCatalog::BrandId brand, int size, Direction direction) {
+        auto order = find(id);
+        std::lock_guard lock(order->mutex);
+        order->rental.addSnowboard(brand, size, direction);
+    }
+
+    void setRentalImplementation(OrderId id, std::shared_ptr<const RentalImplementation> impl) {
+        auto order = find(id);
+        std::lock_guard lock(order->mutex);
+        order->rental.setRentalImplementation(std::move(impl));
+    }
+
+    double calculateTotalPrice(OrderId id) const {
+        auto order = find(id);
+        std::lock_guard lock(order->mutex);
+        return order->rental.calculateTotalPrice();
+    }
+
+    void displayOrder(OrderId id) const {
+        auto order = find(id);
+        std::lock_guard lock(order->mutex);
+        order->rental.displayOrder();
+    }
+
+    std::size_t orderCount() const {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < shardCount; ++i) {
+            std::shared_lock lock(shards[i].mutex);
+            count += shards[i].orders.size();
+        }
+        return count;
+    }
+
+private:
+    struct Order {
+        Order(std::shared_ptr<const RentalImplementation> impl, SnowboardInventory* inventory, RentalLog* log)
+            : rental(std::move(impl), inventory, log) {}
+
+        std::mutex mutex;
+        SnowboardRental rental;
+    };
+
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<OrderId, std::shared_ptr<Order>> orders;
+    };
+
+    Shard& shardFor(OrderId id) const {
+        return shards[id % shardCount];
+    }
+
+    std::shared_ptr<Order> find(OrderId id) const {
+        Shard& shard = shardFor(id);
+        std::shared_lock lock(shard.mutex);
+        auto it = shard.orders.find(id);
+        if (it == shard.orders.end()) {
+            throw std::invalid_argument("Unknown order ID " + std::to_string(id) + ".");
+        }
+        return it->second;
+    }
+
+    SnowboardInventory* inventory;
+    RentalLog* log;
+    std::size_t shardCount;
+    std::unique_ptr<Shard[]> shards;
+    std::atomic<OrderId> nextOrderId{ 1 };
+};
+
+// Every thread plays one rental counter with its own orders.
+void benchmarkRentalService(std::shared_ptr<const RentalImplementation> impl, unsigned threads, std::size_t operationsPerThread) {
+    constexpr std::size_t ordersPerCounter = 16;
+    RentalService service;
+    std::vector<std::vector<RentalService::OrderId>> orders(threads);
+    for (auto& counterOrders : orders) {
+        for (std::size_t i = 0; i < ordersPerCounter; ++i) {
+            counterOrders.push_back(service.openOrder(impl));
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> counters;
+    for (unsigned t = 0; t < threads; ++t) {
+        counters.emplace_back([&, t] {
+            std::array<BrandCatalog::BrandId, 4> brands{};
+            std::size_t next = 0;
+            for (const char* brand : { "Burton", "Salomon", "Nitro", "Ride" }) {
+                brands[next++] = BrandCatalog::instance().intern(brand);
+            }
+            for (std::size_t i = 0; i < operationsPerThread; ++i) {
+                service.addSnowboard(orders[t][i % ordersPerCounter], brands[i % 4], 36 + static_cast<int>(i % 12),
+                    i % 2 == 0 ? Direction::Left : Direction::Right);
+            }
+        });
+    }
+    for (auto& counter : counters) {
+        counter.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double revenue = 0.0;
+    for (const auto& counterOrders : orders) {
+        for (auto id : counterOrders) {
+            revenue += service.calculateTotalPrice(id);
+        }
+    }
+    std::size_t operations = threads * operationsPerThread;
+    std::cout << threads << " counter(s), " << service.orderCount() << " orders: " << operations << " snowboards added in "
+        << seconds * 1e3 << " ms (" << operations / seconds << " ops/s), total $" << revenue << "\n";
+}
+
+void benchmarkRentalLog(std::size_t count) {
+    const char* brandNames[] = { "Burton", "Salomon", "Nitro", "Ride", "Jones", "K2", "Lib Tech", "GNU" };
+    std::vector<BrandCatalog::BrandId> brandIds;
+    for (const char* brand : brandNames) {
+        brandIds.push_back(BrandCatalog::instance().intern(brand));
+    }
+
+    RentalLog log;
+    log.reserve(count);
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> day(0, 150), size(33, 48), brand(0, 7), direction(0, 1);
+    for (std::size_t i = 0; i < count; ++i) {
+        log.append(day(random), brandIds[brand(random)], size(random), direction(random) ? Direction::Right : Direction::Left);
+    }
+
+    auto timed = [&](const char* name, auto&& query) {
+        auto start = std::chrono::steady_clock::now();
+        auto result = query();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << name << ": " << seconds * 1e3 << " ms (" << log.size() / seconds / 1e6 << " million rentals/s)\n";
+        return result;
+    };
+
+    std::cout << count << " rentals in " << log.memoryUsage() / (1024 * 1024) << " MiB\n";
+    auto byBrand = timed("By brand", [&] { return log.countByBrand(); });
+    timed("By shoe size", [&] { return log.countByShoeSize(); });
+    auto byDay = timed("By day", [&] { return log.countByDay(); });
+    RentalFilter filter;
+    filter.firstDay = 30;
+    filter.lastDay = 60;
+    filter.shoeSize = 42;
+    filter.direction = Direction::Left;
+    auto matching = timed("Size 42 left-stance, days 30-60", [&] { return log.count(filter); });
+    std::cout << "Burton rentals: " << byBrand[brandIds[0]] << ", day 0 rentals: " << byDay[0]
+        << ", size 42 left-stance on days 30-60: " << matching << "\n";
+}
+
+// Sustained journaled operations: first appends that rely on the background group
+// commit, then many counters that each wait for their own record to be durable.
+void benchmarkRentalJournal(std::shared_ptr<const RentalImplementation> impl, std::size_t operations) {
+    const std::string path = "rental-benchmark.journal";
+    auto removeFiles = [&] {
+        std::filesystem::remove(path);
+        std::filesystem::remove(path + ".snap");
+    };
+    removeFiles();
+    {
+        RentalJournal journal(path);
+        JournalRecord record{ JournalRecordType::AddSnowboard, "Burton", 42, Direction::Left };
+
+        // Snapshots are left out so the run times journaling alone.
+        SnowboardRental rental(impl);
+        JournaledRental journaled(rental, journal, [&](const std::string&) { return impl; }, "standard",
+            std::numeric_limits<std::size_t>::max());
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < operations; ++i) {
+            journaled.addSnowboard("Burton", 42, "left");
+        }
+        journaled.sync();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        auto grouped = journal.statistics();
+        std::cout << "Journaled rental, group commit: " << operations << " operations in " << seconds * 1e3 << " ms ("
+            << operations / seconds << " ops/s, " << grouped.commits << " fsync(s), "
+            << static_cast<double>(operations) / std::max<std::uint64_t>(1, grouped.commits) << " operations per fsync)\n";
+
+        const unsigned counters = 32;
+        std::size_t perCounter = std::max<std::size_t>(1, operations / 100 / counters);
+        start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < counters; ++t) {
+            threads.emplace_back([&] {
+                for (std::size_t i = 0; i < perCounter; ++i) {
+                    journal.waitDurable(journal.append(record));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        auto total = journal.statistics();
+        std::size_t durableOperations = counters * perCounter;
+        std::uint64_t commits = total.commits - grouped.commits;
+        std::cout << "Durable per operation, " << counters << " counters: " << durableOperations << " operations in "
+            << seconds * 1e3 << " ms (" << durableOperations / seconds << " ops/s, " << commits << " fsync(s), "
+            << static_cast<double>(durableOperations) / std::max<std::uint64_t>(1, commits) << " operations per fsync)\n";
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::size_t replayed;
+    {
+        RentalJournal journal(path);
+        replayed = journal.recovered().size();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Replay: " << replayed << " records in " << seconds * 1e3 << " ms\n";
+    removeFiles();
+}
+
 int main() {
-    std::shared_ptr<RentalImplementation> standardRental = std::make_shared<StandardRental>();
-    std::shared_ptr<RentalImplementation> premiumRental = std::make_shared<PremiumRental>();
+    std::shared_ptr<const RentalImplementation> standardRental = std::make_shared<StandardRental>();
+    std::shared_ptr<const RentalImplementation> premiumRental = std::make_shared<PremiumRental>();
 
-    SnowboardRental rental(standardRental);
+    SnowboardInventory inventory;
+    for (const char* brand : { "Burton", "Salomon", "Nitro", "Ride", "Jones" }) {
+        for (int size = 35; size <= 47; ++size) {
+            inventory.stock(brand, size, Direction::Left, 200);
+            inventory.stock(brand, size, Direction::Right, 200);
+        }
+    }
+
+    RentalLog rentalLog;
+    SnowboardRental rental(standardRental, &inventory, &rentalLog);
+    std::shared_ptr<PricingEngine> pricingEngine;
+
+    auto resolveTier = [&](const std::string& name) -> std::shared_ptr<const RentalImplementation> {
+        if (name == "standard") {
+            return standardRental;
+        }
+        if (name == "premium") {
+            return premiumRental;
+        }
+        std::istringstream fields(name);
+        std::string kind, path, tier;
+        if (fields >> kind >> path >> tier && kind == "dynamic") {
+            auto engine = PricingEngine::load(path);
+            auto impl = std::make_shared<DynamicRental>(engine, tier);
+            pricingEngine = std::move(engine);
+            return impl;
+        }
+        throw std::invalid_argument("Unknown rental tier " + name + ".");
+    };
+
+    std::unique_ptr<RentalJournal> journal;
+    try {
+        journal = std::make_unique<RentalJournal>("rentals.journal");
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    JournaledRental journaled(rental, *journal, resolveTier, "standard");
+    auto replayed = journaled.replay();
+    if (replayed.applied != 0) {
+        std::cout << "Restored " << replayed.applied << " journaled operation(s).\n";
+    }
+    if (replayed.failed != 0) {
+        std::cerr << "Error: " << replayed.failed << " journaled operation(s) could not be restored.\n";
+    }
 
     int choice;
     do {
@@ -101,6 +1695,16 @@ int main() {
             << "2. Show order details\n"
             << "3. Switch to Premium Rental\n"
             << "4. Switch to Standard Rental\n"
+            << "5. Benchmark rental service\n"
+            << "6. Show free snowboards\n"
+            << "7. Return snowboards\n"
+            << "8. Switch to Dynamic Rental\n"
+            << "9. Set rental day\n"
+            << "10. Set demand forecast\n"
+            << "11. Show rental statistics\n"
+            << "12. Benchmark rental log\n"
+            << "13. Save snapshot\n"
+            << "14. Benchmark journal\n"
             << "0. Exit\n"
             << "Your choice: ";
         std::cin >> choice;
@@ -114,18 +1718,170 @@ int main() {
             std::cin >> size;
             std::cout << "Enter binding direction (left/right): ";
             std::cin >> direction;
-            rental.addSnowboard(brand, size, direction);
+            try {
+                journaled.addSnowboard(brand, size, direction);
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << "\n";
+            }
         }
         else if (choice == 2) {
             rental.displayOrder();
         }
         else if (choice == 3) {
-            rental.setRentalImplementation(premiumRental);
-            std::cout << "Switched to Premium Rental.\n";
+            try {
+                journaled.setTier("premium");
+                std::cout << "Switched to Premium Rental.\n";
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << "\n";
+            }
         }
         else if (choice == 4) {
-            rental.setRentalImplementation(standardRental);
-            std::cout << "Switched to Standard Rental.\n";
+            try {
+                journaled.setTier("standard");
+                std::cout << "Switched to Standard Rental.\n";
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << "\n";
+            }
+        }
+        else if (choice == 5) {
+            std::size_t operations;
+            std::cout << "Enter snowboards per counter: ";
+            std::cin >> operations;
+            unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+            for (unsigned threads = 1; threads < maxThreads; threads *= 2) {
+                benchmarkRentalService(standardRental, threads, operations);
+            }
+            benchmarkRentalService(standardRental, maxThreads, operations);
+        }
+        else if (choice == 6) {
+            std::string direction;
+            int size;
+            std::cout << "Enter shoe size: ";
+            std::cin >> size;
+            std::cout << "Enter binding direction (left/right): ";
+            std::cin >> direction;
+            try {
+                Direction parsed = parseDirection(direction);
+                std::cout << "Free snowboards: " << inventory.available(size, parsed) << " of " << inventory.size() << "\n";
+                for (BrandCatalog::BrandId id = 0; id < BrandCatalog::instance().size(); ++id) {
+                    const std::string& brand = BrandCatalog::instance().name(id);
+                    std::cout << "  " << brand << ": " << inventory.available(brand, size, parsed) << "\n";
+                }
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << "\n";
+            }
+        }
+        else if (choice == 7) {
+            try {
+                journaled.returnSnowboards();
+                std::cout << "Snowboards returned.\n";
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << "\n";
+            }
+        }
+        else if (choice == 8) {
+            std::string path, tier;
+            std::cout << "Enter pricing rules file: ";
+            std::cin >> path;
+            try {
+                auto engine = PricingEngine::load(path);
+                std::cout << "Tiers:";
+                for (const auto& name : engine->tiers()) {
+                    std::cout << " " << name;
+                }
+                std::cout << "\nEnter tier: ";
+                std::cin >> tier;
+                journaled.setTier("dynamic " + path + " " + tier);
+                std::cout << "Switched to Dynamic Rental.\n";
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << "\n";
+            }
+        }
+        else if (choice == 9) {
+            int day;
+            std::cout << "Enter rental day (0 = first Monday of the season): ";
+            std::cin >> day;
+            try {
+                journaled.setRentalDay(day);
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << "\n";
+            }
+        }
+        else if (choice == 10) {
+            if (pricingEngine) {
+                int day;
+                double level;
+                std::cout << "Enter day: ";
+                std::cin >> day;
+                std::cout << "Enter expected utilisation (0..1): ";
+                std::cin >> level;
+                try {
+                    pricingEngine->setDemand(day, level);
+                    rental.requote();
+                }
+                catch (const std::exception& e) {
+                    std::cerr << "Error: " << e.what() << "\n";
+                }
+            }
+            else {
+                std::cout << "Load pricing rules first.\n";
+            }
+        }
+        else if (choice == 11) {
+            auto byBrand = rentalLog.countByBrand();
+            auto byShoeSize = rentalLog.countByShoeSize();
+            auto byDay = rentalLog.countByDay();
+            std::cout << "Rentals: " << rentalLog.size() << "\nBy brand:\n";
+            for (BrandCatalog::BrandId id = 0; id < byBrand.size(); ++id) {
+                if (byBrand[id] != 0) {
+                    std::cout << "  " << BrandCatalog::instance().name(id) << ": " << byBrand[id] << "\n";
+                }
+            }
+            std::cout << "By shoe size:\n";
+            for (std::size_t size = 0; size < byShoeSize.size(); ++size) {
+                if (byShoeSize[size] != 0) {
+                    std::cout << "  " << size << ": " << byShoeSize[size] << "\n";
+                }
+            }
+            std::cout << "By day:\n";
+            for (std::size_t day = 0; day < byDay.size(); ++day) {
+                if (byDay[day] != 0) {
+                    std::cout << "  " << day << ": " << byDay[day] << "\n";
+                }
+            }
+        }
+        else if (choice == 12) {
+            std::size_t count;
+            std::cout << "Enter number of rentals: ";
+            std::cin >> count;
+            benchmarkRentalLog(count);
+        }
+        else if (choice == 13) {
+            try {
+                journaled.snapshot();
+                std::cout << "Snapshot saved.\n";
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << "\n";
+            }
+        }
+        else if (choice == 14) {
+            std::size_t operations;
+            std::cout << "Enter number of operations: ";
+            std::cin >> operations;
+            try {
+                benchmarkRentalJournal(standardRental, operations);
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << "\n";
+            }
         }
         else if (choice != 0) {
             std::cout << "Invalid choice. Try again.\n";
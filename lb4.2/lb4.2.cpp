@@ -1,5 +1,323 @@
 #include <iostream>
 #include <memory>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <coroutine>
+#include <exception>
+#include <queue>
+#include <latch>
+#include <utility>
+#include <random>
+#include <functional>
+#include <concepts>
+#include <type_traits>
+#include <array>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <limits>
+
+enum class TraceEventId : std::uint16_t {
+    LaptopPlugIn = 1,
+    NewVagonMatchSocket,
+    OldVagonThinSocket,
+    AdapterConversionStarted,
+    AdapterConversionFinished,
+};
+
+struct TraceEvent {
+    std::uint64_t timestamp;
+    std::uint32_t objectId;
+    TraceEventId eventId;
+    std::uint16_t threadId;
+};
+
+// Single-producer, single-consumer ring owned by one emitting thread and emptied
+// by the drain thread. A full ring drops events rather than blocking the emitter.
+class TraceRing {
+public:
+    static constexpr std::size_t capacity = 4096;
+
+    explicit TraceRing(std::uint16_t threadId) : threadId(threadId) {}
+
+    void push(TraceEventId eventId, std::uint32_t objectId, std::uint64_t timestamp) {
+        std::uint64_t position = head.load(std::memory_order_relaxed);
+        if (position - tail.load(std::memory_order_acquire) == capacity) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        events[position % capacity] = { timestamp, objectId, eventId, threadId };
+        head.store(position + 1, std::memory_order_release);
+    }
+
+    void drainTo(std::vector<TraceEvent>& out) {
+        std::uint64_t position = tail.load(std::memory_order_relaxed);
+        std::uint64_t end = head.load(std::memory_order_acquire);
+        for (; position != end; ++position) {
+            out.push_back(events[position % capacity]);
+        }
+        tail.store(end, std::memory_order_release);
+    }
+
+    bool empty() const {
+        return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+    }
+
+    // Consumer side: throws away whatever is still queued and restarts the drop count.
+    void discard() {
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+        dropped.store(0, std::memory_order_relaxed);
+    }
+
+    std::uint64_t droppedEvents() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    std::atomic<bool> ownerAlive{ true };
+
+private:
+    std::array<TraceEvent, capacity> events;
+    std::uint16_t threadId;
+    alignas(64) std::atomic<std::uint64_t> head{ 0 };
+    alignas(64) std::atomic<std::uint64_t> tail{ 0 };
+    std::atomic<std::uint64_t> dropped{ 0 };
+};
+
+// Process-wide tracer. emit() costs an acquire load of the enabled flag (a plain
+// load on x86) while tracing is off and a ring push while it is on; a background
+// thread drains all rings into the trace file every millisecond. Events that cannot
+// be written count as dropped. The file is a four byte magic and a version followed
+// by raw TraceEvent records in native byte order, grouped by thread.
+class Tracer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static Tracer& instance() {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    static std::uint32_t nextObjectId() {
+        static std::atomic<std::uint32_t> next{ 1 };
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~Tracer() {
+        stop();
+    }
+
+    void start(const std::string& path) {
+        std::lock_guard lock(controlMutex);
+        if (drainer.joinable()) {
+            throw std::runtime_error("Tracing is already running.");
+        }
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            throw std::runtime_error("Cannot create trace file " + path + ".");
+        }
+        // Unbuffered, so a failed fwrite() means exactly those events are lost.
+        std::setvbuf(file, nullptr, _IONBF, 0);
+        std::uint32_t version = formatVersion;
+        if (std::fwrite(magic, 1, sizeof(magic), file) != sizeof(magic) || std::fwrite(&version, sizeof(version), 1, file) != 1) {
+            std::fclose(file);
+            file = nullptr;
+            throw std::runtime_error("Cannot write trace file " + path + ".");
+        }
+        resetRings();
+        origin = Clock::now();
+        stopping = false;
+        drainer = std::thread([this] { drainLoop(); });
+        enabled.store(true, std::memory_order_release);
+    }
+
+    void stop() {
+        std::lock_guard lock(controlMutex);
+        if (!drainer.joinable()) {
+            return;
+        }
+        enabled.store(false, std::memory_order_release);
+        {
+            std::lock_guard wakeLock(wakeMutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        drainer.join();
+        std::fclose(file);
+        file = nullptr;
+    }
+
+    void emit(TraceEventId eventId, std::uint32_t objectId) {
+        if (!enabled.load(std::memory_order_acquire)) {
+            return;
+        }
+        auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - origin).count();
+        localRing().push(eventId, objectId, static_cast<std::uint64_t>(timestamp));
+    }
+
+    std::uint64_t droppedEvents() const {
+        std::lock_guard lock(ringsMutex);
+        return droppedByFinishedThreads + droppedByFailedWrites + std::accumulate(rings.begin(), rings.end(), std::uint64_t{ 0 },
+            [](std::uint64_t total, const auto& ring) { return total + ring->droppedEvents(); });
+    }
+
+private:
+    static constexpr char magic[4] = { 'V', 'T', 'R', 'C' };
+    static constexpr std::uint32_t formatVersion = 1;
+
+    // Keeps the calling thread's ring registered; the drain thread forgets the ring
+    // once its thread has exited and it has been emptied.
+    struct RingOwner {
+        std::shared_ptr<TraceRing> ring;
+
+        ~RingOwner() {
+            if (ring) {
+                ring->ownerAlive.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    Tracer() = default;
+
+    // Events left over from an earlier session, e.g. emitted while stop() was
+    // running, must not show up in the next trace file or its drop count.
+    void resetRings() {
+        std::lock_guard lock(ringsMutex);
+        std::erase_if(rings, [](const auto& ring) { return !ring->ownerAlive.load(std::memory_order_acquire); });
+        for (auto& ring : rings) {
+            ring->discard();
+        }
+        droppedByFinishedThreads = 0;
+        droppedByFailedWrites = 0;
+    }
+
+    TraceRing& localRing() {
+        thread_local RingOwner owner;
+        if (!owner.ring) {
+            std::lock_guard lock(ringsMutex);
+            owner.ring = std::make_shared<TraceRing>(nextThreadId++);
+            rings.push_back(owner.ring);
+        }
+        return *owner.ring;
+    }
+
+    void drainLoop() {
+        std::vector<TraceEvent> batch;
+        bool finishing = false;
+        while (!finishing) {
+            {
+                std::unique_lock lock(wakeMutex);
+                finishing = wake.wait_for(lock, std::chrono::milliseconds(1), [&] { return stopping; });
+            }
+            batch.clear();
+            {
+                std::lock_guard lock(ringsMutex);
+                for (auto it = rings.begin(); it != rings.end();) {
+                    bool finished = !(*it)->ownerAlive.load(std::memory_order_acquire);
+                    (*it)->drainTo(batch);
+                    if (finished && (*it)->empty()) {
+                        droppedByFinishedThreads += (*it)->droppedEvents();
+                        it = rings.erase(it);
+                    }
+                    else {
+                        ++it;
+                    }
+                }
+            }
+            if (!batch.empty()) {
+                std::size_t written = std::fwrite(batch.data(), sizeof(TraceEvent), batch.size(), file);
+                if (written != batch.size()) {
+                    std::lock_guard lock(ringsMutex);
+                    droppedByFailedWrites += batch.size() - written;
+                }
+            }
+        }
+    }
+
+    std::atomic<bool> enabled{ false };
+    Clock::time_point origin;
+
+    mutable std::mutex ringsMutex;
+    std::vector<std::shared_ptr<TraceRing>> rings;
+    std::uint16_t nextThreadId = 0;
+    std::uint64_t droppedByFinishedThreads = 0;
+    std::uint64_t droppedByFailedWrites = 0;
+
+    std::mutex controlMutex;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread drainer;
+    std::FILE* file = nullptr;
+};
+
+inline void trace(TraceEventId eventId, std::uint32_t objectId) {
+    Tracer::instance().emit(eventId, objectId);
+}
+
+// Reads a trace file and prints its events in time order.
+void printTimeline(const std::string& path, std::ostream& out) {
+    std::ifstream input(path, std::ios::binary);
+    char fileMagic[4];
+    std::uint32_t version;
+    if (!input.read(fileMagic, sizeof(fileMagic)) || std::memcmp(fileMagic, "VTRC", 4) != 0
+        || !input.read(reinterpret_cast<char*>(&version), sizeof(version))) {
+        throw std::runtime_error(path + " is not a trace file.");
+    }
+    if (version != 1) {
+        throw std::runtime_error("Unsupported trace version " + std::to_string(version) + ".");
+    }
+    std::vector<TraceEvent> events;
+    TraceEvent event;
+    while (input.read(reinterpret_cast<char*>(&event), sizeof(event))) {
+        events.push_back(event);
+    }
+    std::stable_sort(events.begin(), events.end(),
+        [](const TraceEvent& a, const TraceEvent& b) { return a.timestamp < b.timestamp; });
+
+    for (const auto& entry : events) {
+        const char* source = "Unknown";
+        const char* message = "Unknown event.";
+        switch (entry.eventId) {
+        case TraceEventId::LaptopPlugIn:
+            source = "Laptop";
+            message = "Laptop is plugged in and charging.";
+            break;
+        case TraceEventId::NewVagonMatchSocket:
+            source = "NewVagon";
+            message = "New vagon system: Socket matched. Charging...";
+            break;
+        case TraceEventId::OldVagonThinSocket:
+            source = "OldVagon";
+            message = "Old vagon system: Thin socket found. Adapter required.";
+            break;
+        case TraceEventId::AdapterConversionStarted:
+            source = "Adapter";
+            message = "Adapter in use: Converting thin socket to match socket.";
+            break;
+        case TraceEventId::AdapterConversionFinished:
+            source = "Adapter";
+            message = "Adapter: Conversion successful. Charging laptop.";
+            break;
+        }
+        out << std::fixed << std::setprecision(3) << std::setw(12) << entry.timestamp / 1e3 << " us  thread "
+            << entry.threadId << "  " << source << " #" << entry.objectId << ": " << message << "\n";
+    }
+    out.unsetf(std::ios::floatfield);
+    out << std::setprecision(6);
+}
+
 
 class Laptop {
 public:
@@ -8,9 +326,11 @@ public:
 };
 
 class MyLaptop : public Laptop {
+    std::uint32_t traceId = Tracer::nextObjectId();
+
 public:
     void plugIn() override {
-        std::cout << "Laptop is plugged in and charging.\n";
+        trace(TraceEventId::LaptopPlugIn, traceId);
     }
 };
 
@@ -21,9 +341,11 @@ public:
 };
 
 class NewVagon : public NewVagonSystem {
+    std::uint32_t traceId = Tracer::nextObjectId();
+
 public:
     void matchSocket() override {
-        std::cout << "New vagon system: Socket matched. Charging...\n";
+        trace(TraceEventId::NewVagonMatchSocket, traceId);
     }
 };
 
@@ -31,34 +353,926 @@ class OldVagonSystem {
 public:
     virtual void thinSocket() = 0;
     virtual ~OldVagonSystem() = default;
+
+    // Systems that can serve several sockets in one round trip override this.
+    virtual void thinSockets(std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            thinSocket();
+        }
+    }
 };
 
 class OldVagon : public OldVagonSystem {
+    std::uint32_t traceId = Tracer::nextObjectId();
+
 public:
     void thinSocket() override {
-        std::cout << "Old vagon system: Thin socket found. Adapter required.\n";
+        trace(TraceEventId::OldVagonThinSocket, traceId);
     }
 };
 
 class Adapter : public NewVagonSystem {
     std::shared_ptr<OldVagonSystem> oldVagon;
+    std::uint32_t traceId = Tracer::nextObjectId();
 
 public:
     Adapter(std::shared_ptr<OldVagonSystem> oldVagonSystem) : oldVagon(std::move(oldVagonSystem)) {}
 
     void matchSocket() override {
-        std::cout << "Adapter in use: Converting thin socket to match socket.\n";
+        trace(TraceEventId::AdapterConversionStarted, traceId);
         oldVagon->thinSocket();
-        std::cout << "Adapter: Conversion successful. Charging laptop.\n";
+        trace(TraceEventId::AdapterConversionFinished, traceId);
+    }
+};
+
+template <typename T>
+concept ThinSocketSystem = requires(T& system) {
+    system.thinSocket();
+};
+
+template <typename T>
+concept MatchSocketSystem = requires(T& system) {
+    system.matchSocket();
+};
+
+// Trace policies for StaticAdapter. NoTrace compiles the trace points away;
+// TracerTrace takes an object id and reports to the Tracer like Adapter does.
+struct NoTrace {
+    void emit(TraceEventId) {}
+};
+
+class TracerTrace {
+    std::uint32_t traceId = Tracer::nextObjectId();
+
+public:
+    void emit(TraceEventId eventId) {
+        trace(eventId, traceId);
+    }
+};
+
+// Compile-time counterpart of Adapter for any type with thinSocket(). The adaptee
+// is held by value, or by reference when OldT is a reference type, and called
+// directly, so there is no allocation, reference count or virtual dispatch, and
+// without tracing nothing else either.
+template <typename OldT, typename TracePolicy = NoTrace>
+    requires ThinSocketSystem<std::remove_reference_t<OldT>>
+class StaticAdapter {
+    OldT oldVagon;
+    [[no_unique_address]] TracePolicy tracing;
+
+public:
+    template <typename... Args>
+        requires std::constructible_from<OldT, Args...>
+    explicit StaticAdapter(Args&&... args) : oldVagon(std::forward<Args>(args)...) {}
+
+    void matchSocket() {
+        tracing.emit(TraceEventId::AdapterConversionStarted);
+        oldVagon.thinSocket();
+        tracing.emit(TraceEventId::AdapterConversionFinished);
+    }
+};
+
+// Legacy system that only counts calls, for measuring the adapters themselves.
+class CountingOldVagon final : public OldVagonSystem {
+    std::uint64_t calls = 0;
+
+public:
+    void thinSocket() override {
+        ++calls;
+    }
+
+    std::uint64_t callCount() const {
+        return calls;
+    }
+};
+
+// Stand-in for a remote legacy system: every call, single or batched, costs one
+// round trip of the configured latency.
+class SimulatedOldVagon : public OldVagonSystem {
+    std::chrono::microseconds latency;
+    std::atomic<std::uint64_t> calls{ 0 };
+    std::atomic<std::uint64_t> sockets{ 0 };
+
+public:
+    explicit SimulatedOldVagon(std::chrono::microseconds latency) : latency(latency) {}
+
+    void thinSocket() override {
+        thinSockets(1);
+    }
+
+    void thinSockets(std::size_t count) override {
+        std::this_thread::sleep_for(latency);
+        ++calls;
+        sockets += count;
+    }
+
+    std::uint64_t callCount() const {
+        return calls;
+    }
+
+    std::uint64_t socketCount() const {
+        return sockets;
+    }
+};
+
+// Serves matchSocket() from a pool of legacy endpoints. Callers queue a request and
+// wait; one worker per endpoint takes up to maxBatch queued requests at a time and
+// serves them with a single thinSockets() call.
+class PooledAdapter : public NewVagonSystem {
+public:
+    struct Metrics {
+        std::uint64_t requests = 0;
+        std::uint64_t legacyCalls = 0;
+        std::size_t queueDepth = 0;
+        std::size_t maxQueueDepth = 0;
+        std::chrono::nanoseconds totalCallLatency{ 0 };
+        std::chrono::nanoseconds maxCallLatency{ 0 };
+        std::chrono::nanoseconds totalRequestLatency{ 0 };
+
+        double averageBatch() const {
+            return legacyCalls == 0 ? 0.0 : static_cast<double>(requests) / legacyCalls;
+        }
+
+        std::chrono::nanoseconds averageCallLatency() const {
+            return legacyCalls == 0 ? std::chrono::nanoseconds(0) : totalCallLatency / static_cast<std::int64_t>(legacyCalls);
+        }
+
+        std::chrono::nanoseconds averageRequestLatency() const {
+            return requests == 0 ? std::chrono::nanoseconds(0) : totalRequestLatency / static_cast<std::int64_t>(requests);
+        }
+    };
+
+    PooledAdapter(std::vector<std::shared_ptr<OldVagonSystem>> endpoints, std::size_t maxBatch = 32)
+        : maxBatch(std::max<std::size_t>(1, maxBatch)) {
+        if (endpoints.empty()) {
+            throw std::invalid_argument("Pooled adapter needs at least one legacy endpoint.");
+        }
+        for (auto& endpoint : endpoints) {
+            workers.emplace_back([this, endpoint = std::move(endpoint)] { serve(*endpoint); });
+        }
+    }
+
+    PooledAdapter(const PooledAdapter&) = delete;
+    PooledAdapter& operator=(const PooledAdapter&) = delete;
+
+    ~PooledAdapter() override {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        pending.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void matchSocket() override {
+        std::future<void> done;
+        {
+            std::lock_guard lock(mutex);
+            if (stopping) {
+                throw std::runtime_error("Pooled adapter is shutting down.");
+            }
+            queue.push_back({ std::promise<void>(), Clock::now() });
+            done = queue.back().done.get_future();
+            stats.maxQueueDepth = std::max(stats.maxQueueDepth, queue.size());
+        }
+        pending.notify_one();
+        done.get();
+    }
+
+    Metrics metrics() const {
+        std::lock_guard lock(mutex);
+        Metrics result = stats;
+        result.queueDepth = queue.size();
+        return result;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Request {
+        std::promise<void> done;
+        Clock::time_point queued;
+    };
+
+    void serve(OldVagonSystem& endpoint) {
+        std::vector<Request> batch;
+        std::unique_lock lock(mutex);
+        while (true) {
+            pending.wait(lock, [&] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            std::size_t count = std::min(maxBatch, queue.size());
+            for (std::size_t i = 0; i < count; ++i) {
+                batch.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+            lock.unlock();
+
+            auto start = Clock::now();
+            std::exception_ptr failure;
+            try {
+                endpoint.thinSockets(batch.size());
+            }
+            catch (...) {
+                failure = std::current_exception();
+            }
+            auto finish = Clock::now();
+
+            std::chrono::nanoseconds waited{ 0 };
+            for (auto& request : batch) {
+                waited += finish - request.queued;
+                if (failure) {
+                    request.done.set_exception(failure);
+                }
+                else {
+                    request.done.set_value();
+                }
+            }
+
+            lock.lock();
+            stats.requests += batch.size();
+            ++stats.legacyCalls;
+            stats.totalCallLatency += finish - start;
+            stats.maxCallLatency = std::max<std::chrono::nanoseconds>(stats.maxCallLatency, finish - start);
+            stats.totalRequestLatency += waited;
+            batch.clear();
+        }
+    }
+
+    std::size_t maxBatch;
+    mutable std::mutex mutex;
+    std::condition_variable pending;
+    std::deque<Request> queue;
+    bool stopping = false;
+    Metrics stats;
+    std::vector<std::thread> workers;
+};
+
+// Lazily started coroutine. Awaiting a Task runs it, and the awaiting coroutine is
+// resumed directly when it finishes, rethrowing anything it threw.
+class Task {
+public:
+    struct promise_type {
+        std::coroutine_handle<> continuation = std::noop_coroutine();
+        std::exception_ptr failure;
+
+        Task get_return_object() {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        auto final_suspend() noexcept {
+            struct Resumer {
+                bool await_ready() noexcept {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> finished) noexcept {
+                    return finished.promise().continuation;
+                }
+
+                void await_resume() noexcept {}
+            };
+            return Resumer{};
+        }
+
+        void return_void() {}
+
+        void unhandled_exception() {
+            failure = std::current_exception();
+        }
+    };
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept {
+        return handle.done();
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+
+    void await_resume() {
+        if (handle.promise().failure) {
+            std::rethrow_exception(handle.promise().failure);
+        }
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+// Small thread pool that resumes coroutines, plus one timer thread that hands
+// sleeping coroutines back to the pool when their deadline passes.
+class Scheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit Scheduler(unsigned threads) {
+        for (unsigned i = 0; i < std::max(1u, threads); ++i) {
+            workers.emplace_back([this] { runWorker(); });
+        }
+        timerThread = std::thread([this] { runTimers(); });
+    }
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    ~Scheduler() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        ready.notify_all();
+        timersChanged.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        timerThread.join();
+    }
+
+    void post(std::coroutine_handle<> coroutine) {
+        {
+            std::lock_guard lock(mutex);
+            runnable.push_back(coroutine);
+        }
+        ready.notify_one();
+    }
+
+    // co_await scheduler.schedule() continues on a pool thread.
+    auto schedule() {
+        struct Awaiter {
+            Scheduler& scheduler;
+
+            bool await_ready() const noexcept {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> coroutine) {
+                scheduler.post(coroutine);
+            }
+
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{ *this };
+    }
+
+    // co_await scheduler.sleepFor(d) suspends without holding a thread.
+    auto sleepFor(Clock::duration delay) {
+        struct Awaiter {
+            Scheduler& scheduler;
+            Clock::time_point deadline;
+
+            bool await_ready() const noexcept {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> coroutine) {
+                scheduler.addTimer(deadline, coroutine);
+            }
+
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{ *this, Clock::now() + delay };
+    }
+
+private:
+    struct Timer {
+        Clock::time_point deadline;
+        std::uint64_t order;
+        std::coroutine_handle<> coroutine;
+
+        bool operator>(const Timer& other) const {
+            return deadline != other.deadline ? deadline > other.deadline : order > other.order;
+        }
+    };
+
+    void addTimer(Clock::time_point deadline, std::coroutine_handle<> coroutine) {
+        bool earliest;
+        {
+            std::lock_guard lock(mutex);
+            earliest = timers.empty() || deadline < timers.top().deadline;
+            timers.push({ deadline, nextTimer++, coroutine });
+        }
+        if (earliest) {
+            timersChanged.notify_one();
+        }
+    }
+
+    void runWorker() {
+        std::unique_lock lock(mutex);
+        while (true) {
+            ready.wait(lock, [&] { return stopping || !runnable.empty(); });
+            if (runnable.empty()) {
+                return;
+            }
+            auto coroutine = runnable.front();
+            runnable.pop_front();
+            lock.unlock();
+            coroutine.resume();
+            lock.lock();
+        }
+    }
+
+    void runTimers() {
+        std::unique_lock lock(mutex);
+        while (!stopping) {
+            if (timers.empty()) {
+                timersChanged.wait(lock);
+                continue;
+            }
+            Clock::time_point deadline = timers.top().deadline;
+            if (timersChanged.wait_until(lock, deadline) == std::cv_status::no_timeout) {
+                continue;
+            }
+            bool posted = false;
+            for (auto now = Clock::now(); !timers.empty() && timers.top().deadline <= now; timers.pop()) {
+                runnable.push_back(timers.top().coroutine);
+                posted = true;
+            }
+            if (posted) {
+                ready.notify_all();
+            }
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::condition_variable timersChanged;
+    std::deque<std::coroutine_handle<>> runnable;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers;
+    std::uint64_t nextTimer = 0;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+    std::thread timerThread;
+};
+
+// Starts a task on the scheduler and counts the latch down once it has finished.
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() {
+            return {};
+        }
+
+        std::suspend_never initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+
+        void return_void() {}
+
+        void unhandled_exception() {
+            std::terminate();
+        }
+    };
+};
+
+DetachedTask spawn(Scheduler& scheduler, Task task, std::latch& finished) {
+    co_await scheduler.schedule();
+    try {
+        co_await task;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+    }
+    finished.count_down();
+}
+
+class AsyncLaptop {
+public:
+    virtual Task plugIn() = 0;
+    virtual ~AsyncLaptop() = default;
+};
+
+class AsyncMyLaptop : public AsyncLaptop {
+    std::atomic<std::uint64_t> charges{ 0 };
+
+public:
+    Task plugIn() override {
+        ++charges;
+        co_return;
+    }
+
+    std::uint64_t chargeCount() const {
+        return charges;
+    }
+};
+
+class AsyncNewVagonSystem {
+public:
+    virtual Task matchSocket() = 0;
+    virtual ~AsyncNewVagonSystem() = default;
+};
+
+class AsyncNewVagon : public AsyncNewVagonSystem {
+public:
+    Task matchSocket() override {
+        co_return;
+    }
+};
+
+class AsyncOldVagonSystem {
+public:
+    virtual Task thinSocket() = 0;
+    virtual ~AsyncOldVagonSystem() = default;
+};
+
+// Asynchronous counterpart of SimulatedOldVagon: the round trip is a timer, so
+// waiting for it does not occupy a pool thread.
+class AsyncSimulatedOldVagon : public AsyncOldVagonSystem {
+    Scheduler& scheduler;
+    std::chrono::microseconds latency;
+    std::atomic<std::uint64_t> calls{ 0 };
+
+public:
+    AsyncSimulatedOldVagon(Scheduler& scheduler, std::chrono::microseconds latency) : scheduler(scheduler), latency(latency) {}
+
+    Task thinSocket() override {
+        co_await scheduler.sleepFor(latency);
+        ++calls;
+    }
+
+    std::uint64_t callCount() const {
+        return calls;
+    }
+};
+
+class AsyncAdapter : public AsyncNewVagonSystem {
+    std::shared_ptr<AsyncOldVagonSystem> oldVagon;
+
+public:
+    AsyncAdapter(std::shared_ptr<AsyncOldVagonSystem> oldVagonSystem) : oldVagon(std::move(oldVagonSystem)) {}
+
+    Task matchSocket() override {
+        co_await oldVagon->thinSocket();
     }
 };
 
+Task travelSimulationAsync(AsyncLaptop& laptop, AsyncNewVagonSystem& vagonSystem) {
+    co_await vagonSystem.matchSocket();
+    co_await laptop.plugIn();
+}
+
 void travelSimulation(Laptop& laptop, NewVagonSystem& vagonSystem) {
     vagonSystem.matchSocket();
     laptop.plugIn();
 }
 
-int main() {
+template <MatchSocketSystem VagonT>
+void travelSimulationStatic(Laptop& laptop, VagonT& vagonSystem) {
+    vagonSystem.matchSocket();
+    laptop.plugIn();
+}
+
+// Measures dispatch and creating an adapter per trip against calling the legacy
+// system directly; run it with tracing stopped, so a trace point costs a flag check.
+void benchmarkAdapters(std::size_t iterations) {
+    constexpr std::size_t adapterCount = 16;
+    auto counting = std::make_shared<CountingOldVagon>();
+    auto nanosecondsPerCall = [&](auto&& body) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+    };
+
+    std::vector<std::unique_ptr<NewVagonSystem>> dynamicAdapters;
+    std::vector<StaticAdapter<CountingOldVagon&>> staticAdapters;
+    std::vector<StaticAdapter<CountingOldVagon&, TracerTrace>> tracedAdapters;
+    for (std::size_t i = 0; i < adapterCount; ++i) {
+        dynamicAdapters.push_back(std::make_unique<Adapter>(counting));
+        staticAdapters.emplace_back(*counting);
+        tracedAdapters.emplace_back(*counting);
+    }
+    CountingOldVagon& direct = *counting;
+    double directCall = nanosecondsPerCall([&] {
+        for (std::size_t i = 0; i < iterations; ++i) {
+            direct.thinSocket();
+        }
+    });
+    double dynamicCall = nanosecondsPerCall([&] {
+        for (std::size_t i = 0; i < iterations; ++i) {
+            dynamicAdapters[i % adapterCount]->matchSocket();
+        }
+    });
+    double staticCall = nanosecondsPerCall([&] {
+        for (std::size_t i = 0; i < iterations; ++i) {
+            staticAdapters[i % adapterCount].matchSocket();
+        }
+    });
+    double tracedCall = nanosecondsPerCall([&] {
+        for (std::size_t i = 0; i < iterations; ++i) {
+            tracedAdapters[i % adapterCount].matchSocket();
+        }
+    });
+    double dynamicTrip = nanosecondsPerCall([&] {
+        for (std::size_t i = 0; i < iterations; ++i) {
+            std::unique_ptr<NewVagonSystem> adapter = std::make_unique<Adapter>(counting);
+            adapter->matchSocket();
+        }
+    });
+    double staticTrip = nanosecondsPerCall([&] {
+        for (std::size_t i = 0; i < iterations; ++i) {
+            StaticAdapter<CountingOldVagon&> adapter(*counting);
+            adapter.matchSocket();
+        }
+    });
+
+    std::cout << "Direct legacy call: " << directCall << " ns per call\n"
+        << "Dynamic adapter: " << dynamicCall << " ns per call, " << dynamicTrip << " ns per trip with a new adapter\n"
+        << "Static adapter: " << staticCall << " ns per call, " << staticTrip << " ns per trip with a new adapter\n"
+        << "Static adapter with trace points: " << tracedCall << " ns per call\n"
+        << "Legacy calls made: " << counting->callCount() << "\n";
+}
+
+// Discrete-event model of a rail network over one day. Every train is an independent
+// simulation with its own event queue, so trains run in parallel on worker threads.
+// Vagons are described by kind: a new vagon plugs a device in at once, while an
+// old vagon goes through an adapter that occupies the socket for a conversion delay
+// first and offers fewer sockets. Devices board with a charge need and a trip
+// length, wait for a free socket in their vagon and charge until either they are
+// full or they get off.
+struct RailSimulationConfig {
+    std::size_t trains = 2000;
+    std::size_t vagonsPerTrain = 10;
+    double oldVagonShare = 0.4;
+    std::size_t devicesPerTrain = 1000;
+    std::uint32_t newVagonSockets = 12;
+    std::uint32_t oldVagonSockets = 6;
+    std::int32_t adapterDelaySeconds = 30;
+    std::int32_t dayLengthSeconds = 24 * 60 * 60;
+    std::uint64_t seed = 2024;
+};
+
+struct RailSimulationReport {
+    enum VagonKind { New, Old, KindCount };
+
+    std::uint64_t events = 0;
+    std::uint64_t devices = 0;
+    std::uint64_t fullyCharged = 0;
+    std::uint64_t partiallyCharged = 0;
+    std::uint64_t neverCharged = 0;
+    std::uint64_t waitingSeconds = 0;
+    std::uint32_t longestQueue = 0;
+    std::uint64_t vagons[KindCount] = {};
+    double busySocketSeconds[KindCount] = {};
+    double availableSocketSeconds[KindCount] = {};
+    double wallSeconds = 0.0;
+
+    RailSimulationReport& operator+=(const RailSimulationReport& other) {
+        events += other.events;
+        devices += other.devices;
+        fullyCharged += other.fullyCharged;
+        partiallyCharged += other.partiallyCharged;
+        neverCharged += other.neverCharged;
+        waitingSeconds += other.waitingSeconds;
+        longestQueue = std::max(longestQueue, other.longestQueue);
+        for (int kind = 0; kind < KindCount; ++kind) {
+            vagons[kind] += other.vagons[kind];
+            busySocketSeconds[kind] += other.busySocketSeconds[kind];
+            availableSocketSeconds[kind] += other.availableSocketSeconds[kind];
+        }
+        return *this;
+    }
+};
+
+class RailSimulation {
+public:
+    explicit RailSimulation(RailSimulationConfig config) : config(config) {
+        if (config.vagonsPerTrain == 0 || config.newVagonSockets == 0 || config.oldVagonSockets == 0) {
+            throw std::invalid_argument("Every train needs vagons and every vagon needs sockets.");
+        }
+        if (config.vagonsPerTrain > std::size_t{ std::numeric_limits<std::uint16_t>::max() } + 1) {
+            throw std::invalid_argument("A train can have at most 65536 vagons.");
+        }
+        if (config.dayLengthSeconds <= 0) {
+            throw std::invalid_argument("The simulated day must be longer than zero seconds.");
+        }
+    }
+
+    RailSimulationReport run(unsigned threads) const {
+        threads = std::max(1u, threads);
+        std::vector<RailSimulationReport> partial(threads);
+        std::atomic<std::size_t> nextTrain{ 0 };
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                TrainState state;
+                for (std::size_t train = nextTrain++; train < config.trains; train = nextTrain++) {
+                    simulateTrain(train, state, partial[t]);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        RailSimulationReport report;
+        for (const auto& part : partial) {
+            report += part;
+        }
+        report.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return report;
+    }
+
+private:
+    enum class EventType : std::uint8_t { PlugIn, Unplug };
+
+    struct Event {
+        std::int32_t time;
+        std::uint32_t order;
+        EventType type;
+        std::uint32_t device;
+
+        bool operator>(const Event& other) const {
+            return time != other.time ? time > other.time : order > other.order;
+        }
+    };
+
+    struct Device {
+        std::int32_t board;
+        std::int32_t alight;
+        std::int32_t chargeNeeded;
+        std::int32_t socketTaken;
+        std::uint16_t vagon;
+    };
+
+    struct Vagon {
+        RailSimulationReport::VagonKind kind;
+        std::uint32_t freeSockets;
+        std::deque<std::uint32_t> waiting;
+    };
+
+    // Reused between trains so a worker allocates only while its buffers grow.
+    struct TrainState {
+        std::vector<Device> devices;
+        std::vector<Vagon> vagons;
+        std::vector<Event> heap;
+        std::vector<Event> batch;
+    };
+
+    void simulateTrain(std::size_t train, TrainState& state, RailSimulationReport& report) const {
+        std::mt19937_64 random(config.seed ^ (train * 0x9E3779B97F4A7C15ull));
+        std::uniform_real_distribution<double> share(0.0, 1.0);
+        std::uniform_int_distribution<std::int32_t> boardTime(0, config.dayLengthSeconds - 1);
+        std::uniform_int_distribution<std::int32_t> tripLength(10 * 60, 4 * 60 * 60);
+        std::uniform_int_distribution<std::int32_t> chargeNeed(20 * 60, 2 * 60 * 60);
+        std::uniform_int_distribution<std::size_t> vagonChoice(0, config.vagonsPerTrain - 1);
+
+        state.vagons.clear();
+        for (std::size_t i = 0; i < config.vagonsPerTrain; ++i) {
+            auto kind = share(random) < config.oldVagonShare ? RailSimulationReport::Old : RailSimulationReport::New;
+            std::uint32_t sockets = kind == RailSimulationReport::Old ? config.oldVagonSockets : config.newVagonSockets;
+            state.vagons.push_back({ kind, sockets, {} });
+            ++report.vagons[kind];
+            report.availableSocketSeconds[kind] += static_cast<double>(sockets) * config.dayLengthSeconds;
+        }
+
+        // Boardings are known up front, so they are merged in from a sorted array and
+        // only plug-in and unplug events go through the heap.
+        state.devices.clear();
+        for (std::size_t i = 0; i < config.devicesPerTrain; ++i) {
+            std::int32_t board = boardTime(random);
+            std::int32_t alight = std::min(config.dayLengthSeconds, board + tripLength(random));
+            state.devices.push_back({ board, alight, chargeNeed(random), -1, static_cast<std::uint16_t>(vagonChoice(random)) });
+        }
+        std::sort(state.devices.begin(), state.devices.end(), [](const Device& a, const Device& b) { return a.board < b.board; });
+        report.devices += state.devices.size();
+
+        std::uint32_t order = 0;
+        auto push = [&](std::int32_t time, EventType type, std::uint32_t device) {
+            state.heap.push_back({ time, order++, type, device });
+            std::push_heap(state.heap.begin(), state.heap.end(), std::greater<Event>());
+        };
+        auto takeSocket = [&](std::uint32_t id, std::int32_t now) {
+            Device& device = state.devices[id];
+            Vagon& vagon = state.vagons[device.vagon];
+            --vagon.freeSockets;
+            device.socketTaken = now;
+            report.waitingSeconds += now - device.board;
+            std::int32_t delay = vagon.kind == RailSimulationReport::Old ? config.adapterDelaySeconds : 0;
+            push(now + delay, EventType::PlugIn, id);
+        };
+        auto releaseSocket = [&](Vagon& vagon, std::int32_t now) {
+            ++vagon.freeSockets;
+            while (!vagon.waiting.empty()) {
+                std::uint32_t next = vagon.waiting.front();
+                vagon.waiting.pop_front();
+                if (state.devices[next].alight > now) {
+                    takeSocket(next, now);
+                    return;
+                }
+                ++report.neverCharged;
+            }
+        };
+
+        state.heap.clear();
+        std::size_t nextBoarding = 0;
+        while (!state.heap.empty() || nextBoarding < state.devices.size()) {
+            std::int32_t now = state.heap.empty() ? state.devices[nextBoarding].board : state.heap.front().time;
+            if (nextBoarding < state.devices.size()) {
+                now = std::min(now, state.devices[nextBoarding].board);
+            }
+
+            // Everything due at this instant is handled as one batch: sockets freed by
+            // unplugging are available to the devices boarding at the same time.
+            state.batch.clear();
+            while (!state.heap.empty() && state.heap.front().time == now) {
+                std::pop_heap(state.heap.begin(), state.heap.end(), std::greater<Event>());
+                state.batch.push_back(state.heap.back());
+                state.heap.pop_back();
+            }
+            for (const Event& event : state.batch) {
+                Device& device = state.devices[event.device];
+                Vagon& vagon = state.vagons[device.vagon];
+                if (event.type == EventType::PlugIn) {
+                    if (now >= device.alight) {
+                        ++report.neverCharged;
+                        report.busySocketSeconds[vagon.kind] += now - device.socketTaken;
+                        releaseSocket(vagon, now);
+                    }
+                    else {
+                        push(std::min(device.alight, now + device.chargeNeeded), EventType::Unplug, event.device);
+                    }
+                }
+                else {
+                    std::int32_t pluggedIn = device.socketTaken
+                        + (vagon.kind == RailSimulationReport::Old ? config.adapterDelaySeconds : 0);
+                    if (now - pluggedIn >= device.chargeNeeded) {
+                        ++report.fullyCharged;
+                    }
+                    else {
+                        ++report.partiallyCharged;
+                    }
+                    report.busySocketSeconds[vagon.kind] += now - device.socketTaken;
+                    releaseSocket(vagon, now);
+                }
+            }
+            report.events += state.batch.size();
+
+            for (; nextBoarding < state.devices.size() && state.devices[nextBoarding].board == now; ++nextBoarding) {
+                Vagon& vagon = state.vagons[state.devices[nextBoarding].vagon];
+                if (vagon.freeSockets > 0) {
+                    takeSocket(static_cast<std::uint32_t>(nextBoarding), now);
+                }
+                else {
+                    vagon.waiting.push_back(static_cast<std::uint32_t>(nextBoarding));
+                    report.longestQueue = std::max(report.longestQueue, static_cast<std::uint32_t>(vagon.waiting.size()));
+                }
+                ++report.events;
+            }
+        }
+        for (auto& vagon : state.vagons) {
+            report.neverCharged += vagon.waiting.size();
+            vagon.waiting.clear();
+        }
+    }
+
+    RailSimulationConfig config;
+};
+
+int main(int argc, char* argv[]) {
+    if (argc == 3 && std::string(argv[1]) == "--timeline") {
+        try {
+            printTimeline(argv[2], std::cout);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    const std::string tracePath = "vagon-trace.bin";
+    bool tracing = true;
+    try {
+        Tracer::instance().start(tracePath);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        tracing = false;
+    }
+
     std::shared_ptr<Laptop> myLaptop = std::make_shared<MyLaptop>();
 
     NewVagon modernVagon;
@@ -72,5 +1286,130 @@ int main() {
     std::cout << "\nCase 2: Old vagon with adapter:\n";
     travelSimulation(*myLaptop, adapter);
 
+    std::cout << "\nCase 3: Old vagon with static adapter:\n";
+    StaticAdapter<OldVagon, TracerTrace> staticAdapter;
+    travelSimulationStatic(*myLaptop, staticAdapter);
+
+    if (tracing) {
+        Tracer::instance().stop();
+        std::cout << "\nTrace timeline (" << tracePath << "):\n";
+        printTimeline(tracePath, std::cout);
+        std::cout << "Dropped trace events: " << Tracer::instance().droppedEvents() << "\n";
+    }
+
+    std::cout << "\nAdapter benchmark:\n";
+    benchmarkAdapters(10000000);
+
+    std::cout << "\nCase 4: Pooled adapter over simulated legacy endpoints:\n";
+    {
+        constexpr int laptops = 64;
+        constexpr int requestsPerLaptop = 20;
+        const auto latency = std::chrono::milliseconds(2);
+
+        auto serial = std::make_shared<SimulatedOldVagon>(latency);
+        Adapter direct(serial);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < requestsPerLaptop * 4; ++i) {
+            direct.matchSocket();
+        }
+        double directSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Direct adapter: " << requestsPerLaptop * 4 / directSeconds << " sockets/s\n";
+
+        std::vector<std::shared_ptr<OldVagonSystem>> endpoints;
+        std::vector<std::shared_ptr<SimulatedOldVagon>> simulated;
+        for (int i = 0; i < 4; ++i) {
+            simulated.push_back(std::make_shared<SimulatedOldVagon>(latency));
+            endpoints.push_back(simulated.back());
+        }
+        PooledAdapter pooled(endpoints);
+        start = std::chrono::steady_clock::now();
+        std::vector<std::thread> riders;
+        for (int i = 0; i < laptops; ++i) {
+            riders.emplace_back([&] {
+                for (int j = 0; j < requestsPerLaptop; ++j) {
+                    pooled.matchSocket();
+                }
+            });
+        }
+        for (auto& rider : riders) {
+            rider.join();
+        }
+        double pooledSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        auto metrics = pooled.metrics();
+        std::cout << "Pooled adapter (" << endpoints.size() << " endpoints, " << laptops << " laptops): "
+            << metrics.requests / pooledSeconds << " sockets/s\n"
+            << "Legacy calls: " << metrics.legacyCalls << " (" << metrics.averageBatch() << " sockets per call)\n"
+            << "Queue depth: " << metrics.queueDepth << " now, " << metrics.maxQueueDepth << " at most\n"
+            << "Legacy call latency: " << std::chrono::duration<double, std::milli>(metrics.averageCallLatency()).count()
+            << " ms average, " << std::chrono::duration<double, std::milli>(metrics.maxCallLatency).count() << " ms max\n"
+            << "Request latency: " << std::chrono::duration<double, std::milli>(metrics.averageRequestLatency()).count()
+            << " ms average\n";
+    }
+
+    std::cout << "\nCase 5: Asynchronous simulation:\n";
+    {
+        constexpr std::size_t laptopCount = 5000;
+        constexpr std::size_t vagonCount = 200;
+        constexpr unsigned threads = 4;
+        const auto latency = std::chrono::milliseconds(2);
+
+        Scheduler scheduler(threads);
+        std::vector<std::shared_ptr<AsyncSimulatedOldVagon>> oldVagons;
+        std::vector<std::unique_ptr<AsyncNewVagonSystem>> vagons;
+        for (std::size_t i = 0; i < vagonCount; ++i) {
+            if (i % 2 == 0) {
+                vagons.push_back(std::make_unique<AsyncNewVagon>());
+            }
+            else {
+                oldVagons.push_back(std::make_shared<AsyncSimulatedOldVagon>(scheduler, latency));
+                vagons.push_back(std::make_unique<AsyncAdapter>(oldVagons.back()));
+            }
+        }
+        std::vector<AsyncMyLaptop> laptops(laptopCount);
+
+        std::latch finished(laptopCount);
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < laptopCount; ++i) {
+            spawn(scheduler, travelSimulationAsync(laptops[i], *vagons[i % vagonCount]), finished);
+        }
+        finished.wait();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::uint64_t charged = 0;
+        for (const auto& laptop : laptops) {
+            charged += laptop.chargeCount();
+        }
+        std::uint64_t legacyCalls = 0;
+        for (const auto& vagon : oldVagons) {
+            legacyCalls += vagon->callCount();
+        }
+        std::cout << charged << " laptops charged across " << vagonCount << " vagons on " << threads << " threads in "
+            << seconds * 1e3 << " ms (" << legacyCalls << " legacy calls of "
+            << std::chrono::duration<double, std::milli>(latency).count() << " ms; "
+            << std::chrono::duration<double, std::milli>(latency * legacyCalls).count() << " ms if run one by one)\n";
+    }
+
+    std::cout << "\nCase 6: Rail network simulation:\n";
+    {
+        RailSimulationConfig config;
+        unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        RailSimulationReport report = RailSimulation(config).run(threads);
+        auto utilisation = [&](int kind) {
+            return report.availableSocketSeconds[kind] == 0.0 ? 0.0
+                : 100.0 * report.busySocketSeconds[kind] / report.availableSocketSeconds[kind];
+        };
+        std::uint64_t served = report.fullyCharged + report.partiallyCharged;
+        std::cout << config.trains << " trains, " << report.vagons[RailSimulationReport::New] << " new and "
+            << report.vagons[RailSimulationReport::Old] << " adapted old vagons, " << report.devices << " devices\n"
+            << report.events << " events in " << report.wallSeconds * 1e3 << " ms on " << threads << " thread(s) ("
+            << report.events / report.wallSeconds / 1e6 << " million events/s)\n"
+            << "Fully charged: " << report.fullyCharged << ", partially: " << report.partiallyCharged
+            << ", never: " << report.neverCharged << "\n"
+            << "Average wait for a socket: " << (served == 0 ? 0.0 : static_cast<double>(report.waitingSeconds) / served / 60)
+            << " min, longest queue: " << report.longestQueue << "\n"
+            << "Socket utilisation: " << utilisation(RailSimulationReport::New) << "% in new vagons, "
+            << utilisation(RailSimulationReport::Old) << "% in old vagons\n";
+    }
+
     return 0;
 }